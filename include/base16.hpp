@@ -25,9 +25,21 @@
 #ifndef STLENCODERS_BASE16_HPP
 #define STLENCODERS_BASE16_HPP
 
+#include "base16_simd.hpp"
+#include "buffer.hpp"
+#include "chunk.hpp"
+#include "contiguous.hpp"
 #include "error.hpp"
 #include "lookup.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
 #include "traits.hpp"
+#include "validate.hpp"
+#include "wrap.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
 
 /**
  * @file
@@ -157,6 +169,33 @@ namespace stlencoders {
     : public portable_wchar_encoding_traits<base16_traits<char> > {
     };
 
+    namespace detail {
+        template<class traits> struct base16_block : false_type { };
+
+        template<>
+        struct base16_block<base16_traits<char> > : true_type {
+            static const char* encode_table() {
+                return base16_simd_hex().encode_upper;
+            }
+        };
+
+        template<class traits>
+        struct base16_block<lower_char_encoding_traits<traits> >
+        : base16_block<traits> {
+            static const char* encode_table() {
+                return base16_simd_hex().encode_lower;
+            }
+        };
+
+        template<class traits>
+        struct base16_block<upper_char_encoding_traits<traits> >
+        : base16_block<traits> {
+            static const char* encode_table() {
+                return base16_simd_hex().encode_upper;
+            }
+        };
+    }
+
     /**
      * This class template implements the Base16 encoding as defined
      * in RFC 4648 for a given character type and encoding alphabet.
@@ -178,8 +217,20 @@ namespace stlencoders {
     template<class charT, class traits = base16_traits<charT> >
     class base16 {
     private:
+        template<class, int, int, bool> friend class detail::chunk_decoder;
+
         struct noskip { };
 
+        struct encode_function {
+            template<class InputIterator, class OutputIterator>
+            OutputIterator operator()(
+                InputIterator first, InputIterator last, OutputIterator result
+                ) const
+            {
+                return encode(first, last, result);
+            }
+        };
+
     public:
         /**
          * The encoding character type.
@@ -196,6 +247,40 @@ namespace stlencoders {
          */
         typedef typename traits::int_type int_type;
 
+        /**
+         * A stateful encoder for octet ranges that arrive in chunks.
+         *
+         * Successive calls to update() encode their ranges as if they
+         * were one, holding back octets that do not fill a quantum
+         * until the next call.  finish() encodes whatever is left.
+         */
+        class encoder : public detail::chunk_encoder<encode_function, charT, 2, 1> {
+        public:
+            /**
+             * Constructs an encoder.
+             */
+            encoder()
+            : detail::chunk_encoder<encode_function, charT, 2, 1>(encode_function()) { }
+        };
+
+        /**
+         * A stateful decoder for character ranges that arrive in
+         * chunks.
+         *
+         * Successive calls to update() decode their ranges as if they
+         * were one, holding back the characters of an incomplete
+         * quantum until the next call.  finish() decodes whatever is
+         * left, and checks the total number of encoding characters.
+         */
+        class decoder : public detail::chunk_decoder<base16, 4, 2, false> {
+        public:
+            /**
+             * Constructs a decoder.
+             */
+            decoder()
+            : detail::chunk_decoder<base16, 4, 2, false>("base16 decode error") { }
+        };
+
         /**
          * Encodes a range of octets.
          *
@@ -223,15 +308,48 @@ namespace stlencoders {
             InputIterator first, InputIterator last, OutputIterator result
             )
         {
-            for (; first != last; ++first) {
-                int_type c = *first;
-            	*result = traits::to_char_type((c & 0xff) >> 4);
-                ++result;
-            	*result = traits::to_char_type((c & 0x0f));
-                ++result;
-            }
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return encode(first, last, result, tag());
+        }
 
-            return result;
+        /**
+         * Encodes a range of octets, splitting it into chunks of whole
+         * quanta that are encoded concurrently as requested by @a
+         * policy.  Only the last chunk is padded.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the octet range to be encoded
+         *
+         * @param last a random access iterator to the final position
+         * in the octet range to be encoded
+         *
+         * @param result a random access iterator to the encoded
+         * character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator encode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::parallel_encode(
+                policy, first, last, result, encode_function(), 2, 1
+                );
         }
 
         /**
@@ -298,6 +416,88 @@ namespace stlencoders {
             return base16<charT, upper_traits>::encode(first, last, result);
         }
 
+        /**
+         * Encodes a range of octets, inserting a line delimiter
+         * between lines of a given number of characters.
+         *
+         * Random access ranges are encoded a line at a time, without
+         * testing each character for the end of a line.  Other ranges
+         * are encoded through a line_wrap_iterator.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * octet range to be encoded
+         *
+         * @param last an input iterator to the final position in the
+         * octet range to be encoded
+         *
+         * @param result an output iterator to the encoded character
+         * range
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const char_type* eol
+            )
+        {
+            return detail::encode_wrapped(
+                first, last, result, cols, eol, encode_function(), 2, 1
+                );
+        }
+
+        /**
+         * Encodes a sequence of octet buffers into a sequence of
+         * character buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is encoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of octets consumed and characters
+         * written, with status codec_done if all input has been
+         * encoded, or codec_output_full if the output buffers are
+         * too small
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result encodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            encoder e;
+            return detail::process_buffers<unsigned char, char_type>(
+                e, in, in_count, out, out_count
+                );
+        }
+
         /**
          * Decodes a range of characters.
          *
@@ -377,20 +577,350 @@ namespace stlencoders {
             Predicate skip
             )
         {
-            for (;;) {
-                int_type c0 = seek(first, last, skip);
-                if (traits::eq_int_type(c0, traits::inv())) {
-                    return result;
-                }
+            return detail::decode_result_value(
+                try_decode(first, last, result, skip), "base16 decode error"
+                );
+        }
 
-                int_type c1 = seek(first, last, skip);
-                if (traits::eq_int_type(c1, traits::inv())) {
-                    throw invalid_length("base16 decode error");
-                }
+        /**
+         * Decodes a range of characters, splitting it into chunks of
+         * whole quanta that are decoded concurrently as requested by
+         * @a policy.  Octets may be assigned to the output range
+         * beyond the returned iterator if decoding stops early.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::decode_result_value(
+                detail::parallel_decode<base16>(policy, first, last, result, 2, 1),
+                "base16 decode error"
+                );
+        }
 
-                *result = c0 << 4 | c1;
-                ++result;
-            }
+        /**
+         * Decodes a range of characters, splitting it into chunks that
+         * are decoded concurrently as requested by @a policy.  The
+         * alphabet characters of each chunk are counted first, so
+         * that chunk boundaries can be moved to the start of a
+         * quantum.  Octets may be assigned to the output range beyond
+         * the returned iterator if decoding stops early.
+         *
+         * For every character @c c not in the encoding alphabet,
+         * - if @a skip(c) evaluates to @c true, the character is
+         *   ignored
+         * - otherwise, throws invalid_character
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator, class Predicate>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, Predicate skip
+            )
+        {
+            typedef detail::validator<base16, 4, 2, false> scanner;
+            return detail::decode_result_value(
+                detail::parallel_decode<base16, scanner>(
+                    policy, first, last, result, skip, 2, 1
+                    ),
+                "base16 decode error"
+                );
+        }
+
+        /**
+         * Decodes a range of characters without throwing exceptions.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result
+            )
+        {
+            return try_decode(first, last, result, noskip());
+        }
+
+        /**
+         * Decodes a range of characters without throwing exceptions,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate skip
+            )
+        {
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return decode(first, last, result, skip, tag());
+        }
+
+        /**
+         * Checks whether a range of characters could be decoded,
+         * without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator>
+        static validate_result validate(InputIterator first, InputIterator last)
+        {
+            detail::skip_none skip;
+            return detail::validator<base16, 4, 2, false>::validate(first, last, skip);
+        }
+
+        /**
+         * Checks whether a range of characters could be decoded,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true, without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator, class Predicate>
+        static validate_result validate(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return detail::validator<base16, 4, 2, false>::validate(first, last, skip);
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator>
+        static bool is_valid(InputIterator first, InputIterator last)
+        {
+            return validate(first, last).status == decode_ok;
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error, ignoring characters not in the encoding
+         * alphabet for which @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator, class Predicate>
+        static bool is_valid(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return validate(first, last, skip).status == decode_ok;
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is decoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of characters consumed and octets
+         * written, with status codec_done if all input has been
+         * decoded, codec_output_full if the output buffers are too
+         * small, or codec_error if the input is invalid
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            decoder d;
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as decodev() above, ignoring characters not
+         * in the encoding alphabet for which @a skip evaluates to @c
+         * true.
+         */
+        template<class ConstBuffer, class MutableBuffer, class Predicate>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            Predicate skip
+            )
+        {
+            detail::skipping_decoder<decoder, Predicate> d(skip);
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
         }
 
         /**
@@ -423,7 +953,245 @@ namespace stlencoders {
             return n / 2;
         }
 
+        /**
+         * Computes the exact length of a character sequence encoded
+         * by encode_wrapped(), including line delimiters.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input octet sequence
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @return the length of the encoded character sequence
+         */
+        template<class sizeT>
+        static sizeT wrapped_encode_size(
+            sizeT n, std::size_t cols, const char_type* eol
+            )
+        {
+            return detail::wrapped_size<sizeT>(
+                n * 2, cols,
+                std::char_traits<char_type>::length(eol)
+                );
+        }
+
     private:
+        template<class InputIterator, class OutputIterator, class IteratorTag>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            IteratorTag
+            )
+        {
+            for (; first != last; ++first) {
+                int_type c = *first;
+            	*result = traits::to_char_type((c & 0xff) >> 4);
+                ++result;
+            	*result = traits::to_char_type((c & 0x0f));
+                ++result;
+            }
+
+            return result;
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::random_access_iterator_tag
+            )
+        {
+            const detail::pair_table<traits, 4>& table =
+                detail::pair_table<traits, 4>::instance();
+
+            for (; first != last; ++first) {
+                const char_type* p = table.value[*first & 0xff];
+                *result = p[0];
+                ++result;
+                *result = p[1];
+                ++result;
+            }
+
+            return result;
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            detail::contiguous_iterator_tag
+            )
+        {
+            const unsigned char* src = detail::address<const unsigned char>(first);
+            char_type* dst = detail::address<char_type>(result);
+            return result + (encode_contiguous(src, src + (last - first), dst) - dst);
+        }
+
+        static char_type* encode_contiguous(
+            const unsigned char* first, const unsigned char* last,
+            char_type* result
+            )
+        {
+            encode_block(first, last, result, detail::base16_block<traits>());
+
+            const detail::pair_table<traits, 4>& table =
+                detail::pair_table<traits, 4>::instance();
+
+            for (; first != last; ++first, result += 2) {
+                std::memcpy(result, table.value[*first], sizeof table.value[0]);
+            }
+
+            return result;
+        }
+
+        static void encode_block(
+            const unsigned char*&, const unsigned char*, char_type*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void encode_block(
+            const unsigned char*& first, const unsigned char* last,
+            char_type*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base16_encode_block(
+                first, last - first, reinterpret_cast<char*>(result),
+                detail::base16_block<traits>::encode_table()
+                );
+            first += n;
+            result += n * 2;
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate, class IteratorTag>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, IteratorTag
+            )
+        {
+            InputIterator p = first;
+            decode_status status = decode(p, last, result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, std::distance(first, p));
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, std::input_iterator_tag
+            )
+        {
+            typedef detail::counting_iterator<InputIterator> iterator;
+            iterator p(first);
+            decode_status status = decode(p, iterator(last), result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, p.count());
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, detail::contiguous_iterator_tag
+            )
+        {
+            const char_type* src = detail::address<const char_type>(first);
+            unsigned char* dst = detail::address<unsigned char>(result);
+            typedef detail::bool_constant<detail::is_skip_set<Predicate>::value> skip_set_tag;
+            decode_result<unsigned char*> r =
+                decode_contiguous(src, src + (last - first), dst, skip, skip_set_tag());
+            return detail::make_decode_result(r.status, result + (r.result - dst), r.offset);
+        }
+
+        template<class Predicate>
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, Predicate& skip, detail::false_type
+            )
+        {
+            const char_type* p = first;
+            decode_status status = decode(p, last, result, skip, detail::true_type());
+            return detail::make_decode_result(status, result, p - first);
+        }
+
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, const skip_set& skip, detail::true_type
+            )
+        {
+            return detail::decode_skip_set<base16>(first, last, result, skip);
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate, bool Contiguous>
+        static decode_status decode(
+            InputIterator& first, const InputIterator& last, OutputIterator& result,
+            Predicate& skip, detail::bool_constant<Contiguous> contiguous
+            )
+        {
+            for (;;) {
+                decode_fast(first, last, result, contiguous);
+
+                int_type c0 = seek(first, last, skip);
+                if (traits::eq_int_type(c0, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                int_type c1 = seek(first, last, skip);
+                if (traits::eq_int_type(c1, traits::inv())) {
+                    return stop(first, last, decode_invalid_length);
+                }
+
+                *result = c0 << 4 | c1;
+                ++result;
+            }
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static void decode_fast(
+            InputIterator&, const InputIterator&, OutputIterator&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_fast(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            decode_block(first, last, result, detail::base16_block<traits>());
+
+            for (; last - first >= 2; first += 2, ++result) {
+                const int_type c0 = traits::to_int_type(first[0]);
+                const int_type c1 = traits::to_int_type(first[1]);
+
+                // leave skipped and invalid characters to seek()
+                if ((c0 | c1) & ~0x0f) {
+                    break;
+                }
+
+                *result = c0 << 4 | c1;
+            }
+        }
+
+        static void decode_block(
+            const char_type*&, const char_type*, unsigned char*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_block(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base16_decode_block(
+                reinterpret_cast<const char*>(first), last - first, result
+                );
+            first += n;
+            result += n / 2;
+        }
+
         template<class InputIterator, class Predicate>
         static int_type seek(
             InputIterator& first, const InputIterator& last, Predicate& skip
@@ -431,13 +1199,15 @@ namespace stlencoders {
         {
             while (first != last) {
                 char_type c = *first;
-                ++first;
 
                 int_type v = traits::to_int_type(c);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else if (!skip(c)) {
-                    throw invalid_character("base16 decode error");
+                } else if (skip(c)) {
+                    ++first;
+                } else {
+                    break;
                 }
             }
 
@@ -450,19 +1220,28 @@ namespace stlencoders {
             )
         {
             if (first != last) {
-                char_type c = *first;
-                ++first;
-
-                int_type v = traits::to_int_type(c);
+                int_type v = traits::to_int_type(*first);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else {
-                    throw invalid_character("base16 decode error");
                 }
             }
 
             return traits::inv();
         }
+
+        /*
+         * Returns status if decoding stopped at the end of the input,
+         * or decode_invalid_character otherwise.
+         */
+        template<class InputIterator>
+        static decode_status stop(
+            const InputIterator& first, const InputIterator& last,
+            decode_status status
+            )
+        {
+            return first != last ? decode_invalid_character : status;
+        }
     };
 }
 
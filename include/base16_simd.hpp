@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_BASE16_SIMD_HPP
+#define STLENCODERS_BASE16_SIMD_HPP
+
+#include "dispatch.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+
+/**
+ * @file
+ *
+ * Vectorized block kernels for the Base16 encoding scheme.
+ */
+namespace stlencoders {
+    namespace detail {
+        /*
+         * The uppercase and lowercase Base16 encoding alphabets.
+         * Decoding accepts both cases, and is not table-driven.
+         */
+        struct base16_simd_alphabet {
+            char encode_upper[17];
+            char encode_lower[17];
+        };
+
+        inline const base16_simd_alphabet& base16_simd_hex()
+        {
+            static const base16_simd_alphabet alphabet = {
+                "0123456789ABCDEF",
+                "0123456789abcdef"
+            };
+            return alphabet;
+        }
+
+#if defined(STLENCODERS_SSSE3)
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base16_encode_ssse3(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(table));
+            const __m128i mask = _mm_set1_epi8(0x0f);
+            const unsigned char* p = src;
+
+            for (; n - (p - src) >= 16; p += 16, dst += 32) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(in, 4), mask));
+                __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(in, mask));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi8(hi, lo));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi8(hi, lo));
+            }
+
+            return p - src;
+        }
+
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base16_decode_ssse3(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const char* p = src;
+
+            // letters are folded to lowercase, so both cases are accepted
+            for (; n - (p - src) >= 16; p += 16, dst += 8) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i d = _mm_sub_epi8(in, _mm_set1_epi8('0'));
+                __m128i l = _mm_sub_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+                __m128i dv = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+                __m128i lv = _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8(5)), l);
+                if (_mm_movemask_epi8(_mm_or_si128(dv, lv)) != 0xffff) {
+                    break;
+                }
+
+                __m128i v = _mm_or_si128(
+                    _mm_and_si128(dv, d),
+                    _mm_and_si128(lv, _mm_add_epi8(l, _mm_set1_epi8(10)))
+                    );
+                v = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0110));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(v, v));
+            }
+
+            return p - src;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX2)
+        inline STLENCODERS_TARGET_AVX2 std::size_t base16_encode_avx2(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(table)
+                ));
+            const __m256i mask = _mm256_set1_epi8(0x0f);
+            const unsigned char* p = src;
+
+            for (; n - (p - src) >= 32; p += 32, dst += 64) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(in, 4), mask));
+                __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(in, mask));
+                __m256i l = _mm256_unpacklo_epi8(hi, lo);
+                __m256i h = _mm256_unpackhi_epi8(hi, lo);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(l, h, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32), _mm256_permute2x128_si256(l, h, 0x31));
+            }
+
+            return (p - src) + base16_encode_ssse3(p, n - (p - src), dst, table);
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base16_decode_avx2(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const char* p = src;
+
+            // validate 32 characters at a time
+            for (; n - (p - src) >= 32; p += 32, dst += 16) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i d = _mm256_sub_epi8(in, _mm256_set1_epi8('0'));
+                __m256i l = _mm256_sub_epi8(_mm256_or_si256(in, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+                __m256i dv = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+                __m256i lv = _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8(5)), l);
+                if (_mm256_movemask_epi8(_mm256_or_si256(dv, lv)) != -1) {
+                    break;
+                }
+
+                __m256i v = _mm256_or_si256(
+                    _mm256_and_si256(dv, d),
+                    _mm256_and_si256(lv, _mm256_add_epi8(l, _mm256_set1_epi8(10)))
+                    );
+                v = _mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0110));
+                v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(v));
+            }
+
+            return (p - src) + base16_decode_ssse3(p, n - (p - src), dst);
+        }
+#endif
+
+#if defined(STLENCODERS_AVX512)
+        inline STLENCODERS_TARGET_AVX512 std::size_t base16_encode_avx512(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            const __m512i lut = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(table)
+                ));
+            const unsigned char* p = src;
+
+            // each octet is widened to a word holding its high nibble
+            // in the low byte and its low nibble in the high byte
+            for (; n - (p - src) >= 32; p += 32, dst += 64) {
+                __m512i in = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+                in = _mm512_or_si512(
+                    _mm512_srli_epi16(in, 4),
+                    _mm512_slli_epi16(_mm512_and_si512(in, _mm512_set1_epi16(0x0f)), 8)
+                    );
+                _mm512_storeu_si512(dst, _mm512_shuffle_epi8(lut, in));
+            }
+
+            return (p - src) + base16_encode_avx2(p, n - (p - src), dst, table);
+        }
+
+        inline STLENCODERS_TARGET_AVX512 std::size_t base16_decode_avx512(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const char* p = src;
+
+            for (; n - (p - src) >= 64; p += 64, dst += 32) {
+                __m512i in = _mm512_loadu_si512(p);
+                __m512i d = _mm512_sub_epi8(in, _mm512_set1_epi8('0'));
+                __m512i l = _mm512_sub_epi8(_mm512_or_si512(in, _mm512_set1_epi8(0x20)), _mm512_set1_epi8('a'));
+                __mmask64 dm = _mm512_cmple_epu8_mask(d, _mm512_set1_epi8(9));
+                __mmask64 lm = _mm512_cmple_epu8_mask(l, _mm512_set1_epi8(5));
+                if (~(dm | lm) != 0) {
+                    break;
+                }
+
+                __m512i v = _mm512_mask_blend_epi8(dm, _mm512_add_epi8(l, _mm512_set1_epi8(10)), d);
+                v = _mm512_maddubs_epi16(v, _mm512_set1_epi16(0x0110));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm512_maskz_cvtepi16_epi8(~__mmask32(0), v));
+            }
+
+            return (p - src) + base16_decode_avx2(p, n - (p - src), dst);
+        }
+#endif
+
+        inline std::size_t base16_encode_scalar(
+            const unsigned char*, std::size_t, char*, const char*
+            )
+        {
+            return 0;
+        }
+
+        inline std::size_t base16_decode_scalar(
+            const char*, std::size_t, unsigned char*
+            )
+        {
+            return 0;
+        }
+
+        struct base16_encode_kernel {
+            typedef std::size_t (*function_type)(
+                const unsigned char*, std::size_t, char*, const char*
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base16_encode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base16_encode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base16_encode_ssse3;
+                }
+#endif
+                return base16_encode_scalar;
+            }
+        };
+
+        struct base16_decode_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, unsigned char*
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base16_decode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base16_decode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base16_decode_ssse3;
+                }
+#endif
+                return base16_decode_scalar;
+            }
+        };
+
+        /*
+         * Encodes the longest prefix of [src, src + n) the selected
+         * block kernel can handle using the 16 characters in table,
+         * and returns its length.
+         */
+        inline std::size_t base16_encode_block(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            return dispatch<base16_encode_kernel>::get()(src, n, dst, table);
+        }
+
+        /*
+         * Decodes the longest prefix of [src, src + n) consisting of
+         * complete blocks of encoding characters the selected block
+         * kernel can handle, and returns its length, which is always
+         * a multiple of 2.
+         */
+        inline std::size_t base16_decode_block(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            return dispatch<base16_decode_kernel>::get()(src, n, dst);
+        }
+    }
+}
+
+#endif
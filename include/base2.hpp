@@ -25,9 +25,21 @@
 #ifndef STLENCODERS_BASE2_HPP
 #define STLENCODERS_BASE2_HPP
 
+#include "base2_simd.hpp"
+#include "buffer.hpp"
+#include "chunk.hpp"
+#include "contiguous.hpp"
 #include "error.hpp"
 #include "lookup.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
 #include "traits.hpp"
+#include "validate.hpp"
+#include "wrap.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
 
 /**
  * @file
@@ -121,6 +133,36 @@ namespace stlencoders {
     : public portable_wchar_encoding_traits<base2_traits<char> > {
     };
 
+    namespace detail {
+        /*
+         * Sequences of eight encoding characters for all octet
+         * values, built from the encoding traits on first use.
+         */
+        template<class traits>
+        struct base2_octet_table {
+            typedef typename traits::char_type char_type;
+
+            char_type value[256][8];
+
+            base2_octet_table() {
+                for (int i = 0; i != 256; ++i) {
+                    for (int j = 0; j != 8; ++j) {
+                        value[i][j] = traits::to_char_type(i >> (7 - j) & 1);
+                    }
+                }
+            }
+
+            static const base2_octet_table& instance() {
+                static const base2_octet_table table;
+                return table;
+            }
+        };
+
+        template<class traits> struct base2_block : false_type { };
+
+        template<> struct base2_block<base2_traits<char> > : true_type { };
+    }
+
     /**
      * This class template implements the standard Base2, or binary,
      * encoding.
@@ -138,8 +180,20 @@ namespace stlencoders {
     template<class charT, class traits = base2_traits<charT> >
     class base2 {
     private:
+        template<class, int, int, bool> friend class detail::chunk_decoder;
+
         struct noskip { };
 
+        struct encode_function {
+            template<class InputIterator, class OutputIterator>
+            OutputIterator operator()(
+                InputIterator first, InputIterator last, OutputIterator result
+                ) const
+            {
+                return encode(first, last, result);
+            }
+        };
+
     public:
         /**
          * The encoding character type.
@@ -156,6 +210,40 @@ namespace stlencoders {
          */
         typedef typename traits::int_type int_type;
 
+        /**
+         * A stateful encoder for octet ranges that arrive in chunks.
+         *
+         * Successive calls to update() encode their ranges as if they
+         * were one, holding back octets that do not fill a quantum
+         * until the next call.  finish() encodes whatever is left.
+         */
+        class encoder : public detail::chunk_encoder<encode_function, charT, 8, 1> {
+        public:
+            /**
+             * Constructs an encoder.
+             */
+            encoder()
+            : detail::chunk_encoder<encode_function, charT, 8, 1>(encode_function()) { }
+        };
+
+        /**
+         * A stateful decoder for character ranges that arrive in
+         * chunks.
+         *
+         * Successive calls to update() decode their ranges as if they
+         * were one, holding back the characters of an incomplete
+         * quantum until the next call.  finish() decodes whatever is
+         * left, and checks the total number of encoding characters.
+         */
+        class decoder : public detail::chunk_decoder<base2, 1, 8, false> {
+        public:
+            /**
+             * Constructs a decoder.
+             */
+            decoder()
+            : detail::chunk_decoder<base2, 1, 8, false>("base2 decode error") { }
+        };
+
         /**
          * Encodes a range of octets.
          *
@@ -183,27 +271,130 @@ namespace stlencoders {
             InputIterator first, InputIterator last, OutputIterator result
             )
         {
-            for (; first != last; ++first) {
-                int_type c = *first;
-                *result = traits::to_char_type(c >> 7 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 6 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 5 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 4 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 3 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 2 & 1);
-                ++result;
-                *result = traits::to_char_type(c >> 1 & 1);
-                ++result;
-                *result = traits::to_char_type(c & 1);
-                ++result;
-            }
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return encode(first, last, result, tag());
+        }
 
-            return result;
+        /**
+         * Encodes a range of octets, splitting it into chunks of whole
+         * quanta that are encoded concurrently as requested by @a
+         * policy.  Only the last chunk is padded.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the octet range to be encoded
+         *
+         * @param last a random access iterator to the final position
+         * in the octet range to be encoded
+         *
+         * @param result a random access iterator to the encoded
+         * character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator encode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::parallel_encode(
+                policy, first, last, result, encode_function(), 8, 1
+                );
+        }
+
+        /**
+         * Encodes a range of octets, inserting a line delimiter
+         * between lines of a given number of characters.
+         *
+         * Random access ranges are encoded a line at a time, without
+         * testing each character for the end of a line.  Other ranges
+         * are encoded through a line_wrap_iterator.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * octet range to be encoded
+         *
+         * @param last an input iterator to the final position in the
+         * octet range to be encoded
+         *
+         * @param result an output iterator to the encoded character
+         * range
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const char_type* eol
+            )
+        {
+            return detail::encode_wrapped(
+                first, last, result, cols, eol, encode_function(), 8, 1
+                );
+        }
+
+        /**
+         * Encodes a sequence of octet buffers into a sequence of
+         * character buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is encoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of octets consumed and characters
+         * written, with status codec_done if all input has been
+         * encoded, or codec_output_full if the output buffers are
+         * too small
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result encodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            encoder e;
+            return detail::process_buffers<unsigned char, char_type>(
+                e, in, in_count, out, out_count
+                );
         }
 
         /**
@@ -284,46 +475,626 @@ namespace stlencoders {
             InputIterator first, InputIterator last, OutputIterator result,
             Predicate skip
             )
+        {
+            return detail::decode_result_value(
+                try_decode(first, last, result, skip), "base2 decode error"
+                );
+        }
+
+        /**
+         * Decodes a range of characters, splitting it into chunks of
+         * whole quanta that are decoded concurrently as requested by
+         * @a policy.  Octets may be assigned to the output range
+         * beyond the returned iterator if decoding stops early.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::decode_result_value(
+                detail::parallel_decode<base2>(policy, first, last, result, 8, 1),
+                "base2 decode error"
+                );
+        }
+
+        /**
+         * Decodes a range of characters, splitting it into chunks that
+         * are decoded concurrently as requested by @a policy.  The
+         * alphabet characters of each chunk are counted first, so
+         * that chunk boundaries can be moved to the start of a
+         * quantum.  Octets may be assigned to the output range beyond
+         * the returned iterator if decoding stops early.
+         *
+         * For every character @c c not in the encoding alphabet,
+         * - if @a skip(c) evaluates to @c true, the character is
+         *   ignored
+         * - otherwise, throws invalid_character
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator, class Predicate>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, Predicate skip
+            )
+        {
+            typedef detail::validator<base2, 1, 8, false> scanner;
+            return detail::decode_result_value(
+                detail::parallel_decode<base2, scanner>(
+                    policy, first, last, result, skip, 8, 1
+                    ),
+                "base2 decode error"
+                );
+        }
+
+        /**
+         * Decodes a range of characters without throwing exceptions.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result
+            )
+        {
+            return try_decode(first, last, result, noskip());
+        }
+
+        /**
+         * Decodes a range of characters without throwing exceptions,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate skip
+            )
+        {
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return decode(first, last, result, skip, tag());
+        }
+
+        /**
+         * Checks whether a range of characters could be decoded,
+         * without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator>
+        static validate_result validate(InputIterator first, InputIterator last)
+        {
+            detail::skip_none skip;
+            return detail::validator<base2, 1, 8, false>::validate(first, last, skip);
+        }
+
+        /**
+         * Checks whether a range of characters could be decoded,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true, without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator, class Predicate>
+        static validate_result validate(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return detail::validator<base2, 1, 8, false>::validate(first, last, skip);
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator>
+        static bool is_valid(InputIterator first, InputIterator last)
+        {
+            return validate(first, last).status == decode_ok;
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error, ignoring characters not in the encoding
+         * alphabet for which @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator, class Predicate>
+        static bool is_valid(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return validate(first, last, skip).status == decode_ok;
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is decoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of characters consumed and octets
+         * written, with status codec_done if all input has been
+         * decoded, codec_output_full if the output buffers are too
+         * small, or codec_error if the input is invalid
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            decoder d;
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as decodev() above, ignoring characters not
+         * in the encoding alphabet for which @a skip evaluates to @c
+         * true.
+         */
+        template<class ConstBuffer, class MutableBuffer, class Predicate>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            Predicate skip
+            )
+        {
+            detail::skipping_decoder<decoder, Predicate> d(skip);
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
+        }
+
+        /**
+         * Computes the maximum length of an encoded character
+         * sequence.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input octet sequence
+         *
+         * @return the maximum length of the encoded character
+         * sequence
+         */
+        template<class sizeT>
+        static sizeT max_encode_size(sizeT n) {
+            return n * 8;
+        }
+
+        /**
+         * Computes the maximum length of a decoded octet sequence.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input character sequence
+         *
+         * @return the maximum length of the decoded octet sequence
+         */
+        template<class sizeT>
+        static sizeT max_decode_size(sizeT n) {
+            return n / 8;
+        }
+
+        /**
+         * Computes the exact length of a character sequence encoded
+         * by encode_wrapped(), including line delimiters.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input octet sequence
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @return the length of the encoded character sequence
+         */
+        template<class sizeT>
+        static sizeT wrapped_encode_size(
+            sizeT n, std::size_t cols, const char_type* eol
+            )
+        {
+            return detail::wrapped_size<sizeT>(
+                n * 8, cols,
+                std::char_traits<char_type>::length(eol)
+                );
+        }
+
+    private:
+        template<class InputIterator, class OutputIterator, class IteratorTag>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            IteratorTag
+            )
+        {
+            for (; first != last; ++first) {
+                int_type c = *first;
+                *result = traits::to_char_type(c >> 7 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 6 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 5 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 4 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 3 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 2 & 1);
+                ++result;
+                *result = traits::to_char_type(c >> 1 & 1);
+                ++result;
+                *result = traits::to_char_type(c & 1);
+                ++result;
+            }
+
+            return result;
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::random_access_iterator_tag
+            )
+        {
+            const detail::base2_octet_table<traits>& table =
+                detail::base2_octet_table<traits>::instance();
+
+            for (; first != last; ++first) {
+                const char_type* p = table.value[*first & 0xff];
+                for (int i = 0; i != 8; ++i) {
+                    *result = p[i];
+                    ++result;
+                }
+            }
+
+            return result;
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            detail::contiguous_iterator_tag
+            )
+        {
+            const unsigned char* src = detail::address<const unsigned char>(first);
+            char_type* dst = detail::address<char_type>(result);
+            return result + (encode_contiguous(src, src + (last - first), dst) - dst);
+        }
+
+        static char_type* encode_contiguous(
+            const unsigned char* first, const unsigned char* last,
+            char_type* result
+            )
+        {
+            encode_block(first, last, result, detail::base2_block<traits>());
+
+            const unsigned long long ones = 0x0101010101010101ULL;
+            const unsigned long long zero = ones * static_cast<unsigned char>(traits::to_char_type(0));
+            const unsigned long long flip = static_cast<unsigned char>(
+                traits::to_char_type(0) ^ traits::to_char_type(1)
+                );
+
+            for (; first != last; ++first, result += 8) {
+                // spread the bits of an octet to the low bits of 8
+                // bytes, most significant bit to least significant byte
+                const unsigned long long v =
+                    ((*first * 0x8040201008040201ULL >> 7 & ones) * flip) ^ zero;
+                const unsigned char buf[8] = {
+                    static_cast<unsigned char>(v),
+                    static_cast<unsigned char>(v >> 8),
+                    static_cast<unsigned char>(v >> 16),
+                    static_cast<unsigned char>(v >> 24),
+                    static_cast<unsigned char>(v >> 32),
+                    static_cast<unsigned char>(v >> 40),
+                    static_cast<unsigned char>(v >> 48),
+                    static_cast<unsigned char>(v >> 56)
+                };
+                std::memcpy(result, buf, sizeof buf);
+            }
+
+            return result;
+        }
+
+        static void encode_block(
+            const unsigned char*&, const unsigned char*, char_type*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void encode_block(
+            const unsigned char*& first, const unsigned char* last,
+            char_type*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base2_encode_block(
+                first, last - first, reinterpret_cast<char*>(result)
+                );
+            first += n;
+            result += n * 8;
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate, class IteratorTag>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, IteratorTag
+            )
+        {
+            InputIterator p = first;
+            decode_status status = decode(p, last, result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, std::distance(first, p));
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, std::input_iterator_tag
+            )
+        {
+            typedef detail::counting_iterator<InputIterator> iterator;
+            iterator p(first);
+            decode_status status = decode(p, iterator(last), result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, p.count());
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, detail::contiguous_iterator_tag
+            )
+        {
+            const char_type* src = detail::address<const char_type>(first);
+            unsigned char* dst = detail::address<unsigned char>(result);
+            typedef detail::bool_constant<detail::is_skip_set<Predicate>::value> skip_set_tag;
+            decode_result<unsigned char*> r =
+                decode_contiguous(src, src + (last - first), dst, skip, skip_set_tag());
+            return detail::make_decode_result(r.status, result + (r.result - dst), r.offset);
+        }
+
+        template<class Predicate>
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, Predicate& skip, detail::false_type
+            )
+        {
+            const char_type* p = first;
+            decode_status status = decode(p, last, result, skip, detail::true_type());
+            return detail::make_decode_result(status, result, p - first);
+        }
+
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, const skip_set& skip, detail::true_type
+            )
+        {
+            return detail::decode_skip_set<base2>(first, last, result, skip);
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate, bool Contiguous>
+        static decode_status decode(
+            InputIterator& first, const InputIterator& last, OutputIterator& result,
+            Predicate& skip, detail::bool_constant<Contiguous> contiguous
+            )
         {
             for (;;) {
+                decode_fast(first, last, result, contiguous);
+
                 int_type c0 = seek(first, last, skip);
                 if (traits::eq_int_type(c0, traits::inv())) {
-                    return result;
+                    return stop(first, last, decode_ok);
                 }
 
                 int_type c1 = seek(first, last, skip);
                 if (traits::eq_int_type(c1, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c2 = seek(first, last, skip);
                 if (traits::eq_int_type(c2, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c3 = seek(first, last, skip);
                 if (traits::eq_int_type(c3, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c4 = seek(first, last, skip);
                 if (traits::eq_int_type(c4, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c5 = seek(first, last, skip);
                 if (traits::eq_int_type(c5, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c6 = seek(first, last, skip);
                 if (traits::eq_int_type(c6, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 int_type c7 = seek(first, last, skip);
                 if (traits::eq_int_type(c7, traits::inv())) {
-                    throw invalid_length("base2 decode error");
+                    return stop(first, last, decode_invalid_length);
                 }
 
                 *result = (c0 << 7 | c1 << 6 | c2 << 5 | c3 << 4 |
@@ -332,37 +1103,62 @@ namespace stlencoders {
             }
         }
 
-        /**
-         * Computes the maximum length of an encoded character
-         * sequence.
-         *
-         * @tparam sizeT an integral type
-         *
-         * @param n the length of the input octet sequence
-         *
-         * @return the maximum length of the encoded character
-         * sequence
-         */
-        template<class sizeT>
-        static sizeT max_encode_size(sizeT n) {
-            return n * 8;
+        template<class InputIterator, class OutputIterator>
+        static void decode_fast(
+            InputIterator&, const InputIterator&, OutputIterator&,
+            detail::false_type
+            )
+        {
         }
 
-        /**
-         * Computes the maximum length of a decoded octet sequence.
-         *
-         * @tparam sizeT an integral type
-         *
-         * @param n the length of the input character sequence
-         *
-         * @return the maximum length of the decoded octet sequence
-         */
-        template<class sizeT>
-        static sizeT max_decode_size(sizeT n) {
-            return n / 8;
+        static void decode_fast(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            decode_block(first, last, result, detail::base2_block<traits>());
+
+            for (; last - first >= 8; first += 8, ++result) {
+                const unsigned long long v =
+                    static_cast<unsigned long long>(traits::to_int_type(first[0])) << 56 |
+                    static_cast<unsigned long long>(traits::to_int_type(first[1])) << 48 |
+                    static_cast<unsigned long long>(traits::to_int_type(first[2])) << 40 |
+                    static_cast<unsigned long long>(traits::to_int_type(first[3])) << 32 |
+                    static_cast<unsigned long>(traits::to_int_type(first[4])) << 24 |
+                    static_cast<unsigned long>(traits::to_int_type(first[5])) << 16 |
+                    static_cast<unsigned long>(traits::to_int_type(first[6])) << 8 |
+                    static_cast<unsigned long>(traits::to_int_type(first[7]));
+
+                // leave skipped and invalid characters to seek()
+                if (v & ~0x0101010101010101ULL) {
+                    break;
+                }
+
+                // gather the low bits of all bytes, most significant
+                // byte to most significant bit
+                *result = static_cast<unsigned char>(v * 0x0102040810204080ULL >> 56);
+            }
+        }
+
+        static void decode_block(
+            const char_type*&, const char_type*, unsigned char*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_block(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base2_decode_block(
+                reinterpret_cast<const char*>(first), last - first, result
+                );
+            first += n;
+            result += n / 8;
         }
 
-    private:
         template<class InputIterator, class Predicate>
         static int_type seek(
             InputIterator& first, const InputIterator& last, Predicate& skip
@@ -370,13 +1166,15 @@ namespace stlencoders {
         {
             while (first != last) {
                 char_type c = *first;
-                ++first;
 
                 int_type v = traits::to_int_type(c);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else if (!skip(c)) {
-                    throw invalid_character("base2 decode error");
+                } else if (skip(c)) {
+                    ++first;
+                } else {
+                    break;
                 }
             }
 
@@ -389,19 +1187,28 @@ namespace stlencoders {
             )
         {
             if (first != last) {
-                char_type c = *first;
-                ++first;
-
-                int_type v = traits::to_int_type(c);
+                int_type v = traits::to_int_type(*first);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else {
-                    throw invalid_character("base2 decode error");
                 }
             }
 
             return traits::inv();
         }
+
+        /*
+         * Returns status if decoding stopped at the end of the input,
+         * or decode_invalid_character otherwise.
+         */
+        template<class InputIterator>
+        static decode_status stop(
+            const InputIterator& first, const InputIterator& last,
+            decode_status status
+            )
+        {
+            return first != last ? decode_invalid_character : status;
+        }
     };
 }
 
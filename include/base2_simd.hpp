@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_BASE2_SIMD_HPP
+#define STLENCODERS_BASE2_SIMD_HPP
+
+#include "dispatch.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @file
+ *
+ * Vectorized block kernels for the Base2 encoding scheme.
+ *
+ * The kernels only support the standard alphabet of '0' and '1'.
+ */
+namespace stlencoders {
+    namespace detail {
+#if defined(STLENCODERS_SSSE3)
+        /*
+         * Each octet is broadcast to 8 bytes, which are tested
+         * against its bits from most to least significant.
+         */
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base2_encode_ssse3(
+            const unsigned char* src, std::size_t n, char* dst
+            )
+        {
+            const __m128i bits = _mm_set1_epi64x(0x0102040810204080LL);
+            const __m128i zero = _mm_set1_epi8('0');
+            const unsigned char* p = src;
+
+            for (; n - (p - src) >= 16; p += 16) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i index = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+                for (int i = 0; i != 8; ++i, dst += 16) {
+                    __m128i v = _mm_and_si128(_mm_shuffle_epi8(in, index), bits);
+                    v = _mm_sub_epi8(zero, _mm_cmpeq_epi8(v, bits));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+                    index = _mm_add_epi8(index, _mm_set1_epi8(2));
+                }
+            }
+
+            return p - src;
+        }
+
+        /*
+         * Gathers one bit per character with pmovmskb, after
+         * reversing each group of 8 characters so the first one
+         * ends up in the most significant bit.
+         */
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base2_decode_ssse3(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const __m128i reverse = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+            const __m128i one = _mm_set1_epi8('1');
+            const char* p = src;
+
+            for (; n - (p - src) >= 16; p += 16, dst += 2) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(in, _mm_set1_epi8(1)), one)) != 0xffff) {
+                    break;
+                }
+
+                int v = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_shuffle_epi8(in, reverse), one));
+                dst[0] = static_cast<unsigned char>(v);
+                dst[1] = static_cast<unsigned char>(v >> 8);
+            }
+
+            return p - src;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX2)
+        inline STLENCODERS_TARGET_AVX2 std::size_t base2_encode_avx2(
+            const unsigned char* src, std::size_t n, char* dst
+            )
+        {
+            const __m256i bits = _mm256_set1_epi64x(0x0102040810204080LL);
+            const __m256i zero = _mm256_set1_epi8('0');
+            const unsigned char* p = src;
+
+            for (; n - (p - src) >= 16; p += 16) {
+                __m256i in = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+                __m256i index = _mm256_setr_epi8(
+                    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                    2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3
+                    );
+                for (int i = 0; i != 4; ++i, dst += 32) {
+                    __m256i v = _mm256_and_si256(_mm256_shuffle_epi8(in, index), bits);
+                    v = _mm256_sub_epi8(zero, _mm256_cmpeq_epi8(v, bits));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+                    index = _mm256_add_epi8(index, _mm256_set1_epi8(4));
+                }
+            }
+
+            return (p - src) + base2_encode_ssse3(p, n - (p - src), dst);
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base2_decode_avx2(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const __m256i reverse = _mm256_setr_epi8(
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+                );
+            const __m256i one = _mm256_set1_epi8('1');
+            const char* p = src;
+
+            for (; n - (p - src) >= 32; p += 32, dst += 4) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_or_si256(in, _mm256_set1_epi8(1)), one)) != -1) {
+                    break;
+                }
+
+                int v = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(in, reverse), one));
+                std::memcpy(dst, &v, 4);
+            }
+
+            return (p - src) + base2_decode_ssse3(p, n - (p - src), dst);
+        }
+#endif
+
+#if defined(STLENCODERS_AVX512)
+        inline STLENCODERS_TARGET_AVX512 std::size_t base2_encode_avx512(
+            const unsigned char* src, std::size_t n, char* dst
+            )
+        {
+            const __m512i index = _mm512_set_epi64(
+                0x0707070707070707LL, 0x0606060606060606LL,
+                0x0505050505050505LL, 0x0404040404040404LL,
+                0x0303030303030303LL, 0x0202020202020202LL,
+                0x0101010101010101LL, 0x0000000000000000LL
+                );
+            const __m512i bits = _mm512_set1_epi64(0x0102040810204080LL);
+            const __m512i zero = _mm512_set1_epi8('0');
+            const __m512i one = _mm512_set1_epi8('1');
+            const unsigned char* p = src;
+
+            for (; n - (p - src) >= 8; p += 8, dst += 64) {
+                long long word;
+                std::memcpy(&word, p, 8);
+                __m512i in = _mm512_maskz_permutexvar_epi8(~__mmask64(0), index, _mm512_set1_epi64(word));
+                __mmask64 set = _mm512_test_epi8_mask(in, bits);
+                _mm512_storeu_si512(dst, _mm512_mask_blend_epi8(set, zero, one));
+            }
+
+            return p - src;
+        }
+
+        inline STLENCODERS_TARGET_AVX512 std::size_t base2_decode_avx512(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            const __m512i reverse = _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(
+                7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8
+                ));
+            const __m512i one = _mm512_set1_epi8('1');
+            const char* p = src;
+
+            for (; n - (p - src) >= 64; p += 64, dst += 8) {
+                __m512i in = _mm512_loadu_si512(p);
+                if (~_mm512_cmpeq_epi8_mask(_mm512_or_si512(in, _mm512_set1_epi8(1)), one) != 0) {
+                    break;
+                }
+
+                __mmask64 v = _mm512_cmpeq_epi8_mask(_mm512_shuffle_epi8(in, reverse), one);
+                std::memcpy(dst, &v, 8);
+            }
+
+            return (p - src) + base2_decode_avx2(p, n - (p - src), dst);
+        }
+#endif
+
+        inline std::size_t base2_encode_scalar(
+            const unsigned char*, std::size_t, char*
+            )
+        {
+            return 0;
+        }
+
+        inline std::size_t base2_decode_scalar(
+            const char*, std::size_t, unsigned char*
+            )
+        {
+            return 0;
+        }
+
+        struct base2_encode_kernel {
+            typedef std::size_t (*function_type)(
+                const unsigned char*, std::size_t, char*
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base2_encode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base2_encode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base2_encode_ssse3;
+                }
+#endif
+                return base2_encode_scalar;
+            }
+        };
+
+        struct base2_decode_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, unsigned char*
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base2_decode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base2_decode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base2_decode_ssse3;
+                }
+#endif
+                return base2_decode_scalar;
+            }
+        };
+
+        /*
+         * Encodes the longest prefix of [src, src + n) the selected
+         * block kernel can handle, and returns its length.
+         */
+        inline std::size_t base2_encode_block(
+            const unsigned char* src, std::size_t n, char* dst
+            )
+        {
+            return dispatch<base2_encode_kernel>::get()(src, n, dst);
+        }
+
+        /*
+         * Decodes the longest prefix of [src, src + n) consisting of
+         * complete blocks of encoding characters the selected block
+         * kernel can handle, and returns its length, which is always
+         * a multiple of 8.
+         */
+        inline std::size_t base2_decode_block(
+            const char* src, std::size_t n, unsigned char* dst
+            )
+        {
+            return dispatch<base2_decode_kernel>::get()(src, n, dst);
+        }
+    }
+}
+
+#endif
@@ -25,10 +25,20 @@
 #ifndef STLENCODERS_BASE32_HPP
 #define STLENCODERS_BASE32_HPP
 
+#include "base32_simd.hpp"
+#include "buffer.hpp"
+#include "chunk.hpp"
+#include "contiguous.hpp"
 #include "error.hpp"
 #include "lookup.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
 #include "traits.hpp"
+#include "validate.hpp"
+#include "wrap.hpp"
 
+#include <cstddef>
+#include <cstring>
 #include <iterator>
 
 /**
@@ -363,6 +373,48 @@ namespace stlencoders {
     : portable_wchar_encoding_traits<base32hex_traits<char> > {
     };
 
+    namespace detail {
+        template<class traits> struct base32_block : false_type { };
+
+        template<>
+        struct base32_block<base32_traits<char> > : true_type {
+            static const base32_simd_alphabet& alphabet() {
+                return base32_simd_std();
+            }
+
+            static const char* encode_table() {
+                return alphabet().encode_upper;
+            }
+        };
+
+        template<>
+        struct base32_block<base32hex_traits<char> > : true_type {
+            static const base32_simd_alphabet& alphabet() {
+                return base32_simd_hex();
+            }
+
+            static const char* encode_table() {
+                return alphabet().encode_upper;
+            }
+        };
+
+        template<class traits>
+        struct base32_block<lower_char_encoding_traits<traits> >
+        : base32_block<traits> {
+            static const char* encode_table() {
+                return base32_block<traits>::alphabet().encode_lower;
+            }
+        };
+
+        template<class traits>
+        struct base32_block<upper_char_encoding_traits<traits> >
+        : base32_block<traits> {
+            static const char* encode_table() {
+                return base32_block<traits>::alphabet().encode_upper;
+            }
+        };
+    }
+
     /**
      * This class template implements the Base32 encoding as defined
      * in RFC 4648 for a given character type and encoding alphabet.
@@ -385,8 +437,24 @@ namespace stlencoders {
     template<class charT, class traits = base32_traits<charT> >
     class base32 {
     private:
+        template<class, int, int, bool> friend class detail::chunk_decoder;
+
         struct noskip { };
 
+        struct encode_function {
+            explicit encode_function(bool p) : pad(p) { }
+
+            template<class InputIterator, class OutputIterator>
+            OutputIterator operator()(
+                InputIterator first, InputIterator last, OutputIterator result
+                ) const
+            {
+                return encode(first, last, result, pad);
+            }
+
+            bool pad;
+        };
+
     public:
         /**
          * The encoding character type.
@@ -403,6 +471,43 @@ namespace stlencoders {
          */
         typedef typename traits::int_type int_type;
 
+        /**
+         * A stateful encoder for octet ranges that arrive in chunks.
+         *
+         * Successive calls to update() encode their ranges as if they
+         * were one, holding back octets that do not fill a quantum
+         * until the next call.  finish() encodes whatever is left.
+         */
+        class encoder : public detail::chunk_encoder<encode_function, charT, 8, 5> {
+        public:
+            /**
+             * Constructs an encoder.
+             *
+             * @param pad if @c true, finish() performs padding at the
+             * end of the encoded character range
+             */
+            explicit encoder(bool pad = true)
+            : detail::chunk_encoder<encode_function, charT, 8, 5>(encode_function(pad)) { }
+        };
+
+        /**
+         * A stateful decoder for character ranges that arrive in
+         * chunks.
+         *
+         * Successive calls to update() decode their ranges as if they
+         * were one, holding back the characters of an incomplete
+         * quantum until the next call.  finish() decodes whatever is
+         * left, and checks the total number of encoding characters.
+         */
+        class decoder : public detail::chunk_decoder<base32, 5, 8, true> {
+        public:
+            /**
+             * Constructs a decoder.
+             */
+            decoder()
+            : detail::chunk_decoder<base32, 5, 8, true>("base32 decode error") { }
+        };
+
         /**
          * Encodes a range of octets.
          *
@@ -434,10 +539,53 @@ namespace stlencoders {
             bool pad = true
             )
         {
-            typedef typename std::iterator_traits<InputIterator>::iterator_category tag;
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
             return encode(first, last, result, pad, tag());
         }
 
+        /**
+         * Encodes a range of octets, splitting it into chunks of whole
+         * quanta that are encoded concurrently as requested by @a
+         * policy.  Only the last chunk is padded.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the octet range to be encoded
+         *
+         * @param last a random access iterator to the final position
+         * in the octet range to be encoded
+         *
+         * @param result a random access iterator to the encoded
+         * character range
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator encode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, bool pad = true
+            )
+        {
+            return detail::parallel_encode(
+                policy, first, last, result, encode_function(pad), 8, 5
+                );
+        }
+
         /**
          * Encodes a range of octets using the lowercase encoding
          * alphabet.
@@ -510,6 +658,96 @@ namespace stlencoders {
             return base32<charT, upper_traits>::encode(first, last, result, pad);
         }
 
+        /**
+         * Encodes a range of octets, inserting a line delimiter
+         * between lines of a given number of characters.
+         *
+         * Random access ranges are encoded a line at a time, without
+         * testing each character for the end of a line.  Other ranges
+         * are encoded through a line_wrap_iterator.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * octet range to be encoded
+         *
+         * @param last an input iterator to the final position in the
+         * octet range to be encoded
+         *
+         * @param result an output iterator to the encoded character
+         * range
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const char_type* eol,
+            bool pad = true
+            )
+        {
+            return detail::encode_wrapped(
+                first, last, result, cols, eol, encode_function(pad), 8, 5
+                );
+        }
+
+        /**
+         * Encodes a sequence of octet buffers into a sequence of
+         * character buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is encoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return the total number of octets consumed and characters
+         * written, with status codec_done if all input has been
+         * encoded, or codec_output_full if the output buffers are
+         * too small
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result encodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            bool pad = true
+            )
+        {
+            encoder e(pad);
+            return detail::process_buffers<unsigned char, char_type>(
+                e, in, in_count, out, out_count
+                );
+        }
+
         /**
          * Decodes a range of characters.
          *
@@ -588,62 +826,351 @@ namespace stlencoders {
             InputIterator first, InputIterator last, OutputIterator result,
             Predicate skip)
         {
-            for (;;) {
-                int_type c0 = seek(first, last, skip);
-                if (traits::eq_int_type(c0, traits::inv())) {
-                    return result;
-                }
-
-                int_type c1 = seek(first, last, skip);
-                if (traits::eq_int_type(c1, traits::inv())) {
-                    throw invalid_length("base32 decode error");
-                }
-
-                *result = c0 << 3 | c1 >> 2;
-                ++result;
+            return detail::decode_result_value(
+                try_decode(first, last, result, skip), "base32 decode error"
+                );
+        }
 
-                int_type c2 = seek(first, last, skip);
-                if (traits::eq_int_type(c2, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Decodes a range of characters, splitting it into chunks of
+         * whole quanta that are decoded concurrently as requested by
+         * @a policy.  Octets may be assigned to the output range
+         * beyond the returned iterator if decoding stops early.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::decode_result_value(
+                detail::parallel_decode<base32>(policy, first, last, result, 8, 5),
+                "base32 decode error"
+                );
+        }
 
-                int_type c3 = seek(first, last, skip);
-                if (traits::eq_int_type(c3, traits::inv())) {
-                    throw invalid_length("base32 decode error");
-                }
+        /**
+         * Decodes a range of characters, splitting it into chunks that
+         * are decoded concurrently as requested by @a policy.  The
+         * alphabet characters of each chunk are counted first, so
+         * that chunk boundaries can be moved to the start of a
+         * quantum.  Octets may be assigned to the output range beyond
+         * the returned iterator if decoding stops early.
+         *
+         * For every character @c c not in the encoding alphabet,
+         * - if @a skip(c) evaluates to @c true, the character is
+         *   ignored
+         * - if @c c equals @c traits::pad(), returns
+         * - otherwise, throws invalid_character
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator, class Predicate>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, Predicate skip
+            )
+        {
+            typedef detail::validator<base32, 5, 8, true> scanner;
+            return detail::decode_result_value(
+                detail::parallel_decode<base32, scanner>(
+                    policy, first, last, result, skip, 8, 5
+                    ),
+                "base32 decode error"
+                );
+        }
 
-                *result = (c1 & 0x03) << 6 | c2 << 1 | c3 >> 4;
-                ++result;
+        /**
+         * Decodes a range of characters without throwing exceptions.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result
+            )
+        {
+            return try_decode(first, last, result, noskip());
+        }
 
-                int_type c4 = seek(first, last, skip);
-                if (traits::eq_int_type(c4, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Decodes a range of characters without throwing exceptions,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate skip
+            )
+        {
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return decode(first, last, result, skip, tag());
+        }
 
-                *result = (c3 & 0x0f) << 4 | c4 >> 1;
-                ++result;
+        /**
+         * Checks whether a range of characters could be decoded,
+         * without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator>
+        static validate_result validate(InputIterator first, InputIterator last)
+        {
+            detail::skip_none skip;
+            return detail::validator<base32, 5, 8, true>::validate(first, last, skip);
+        }
 
-                int_type c5 = seek(first, last, skip);
-                if (traits::eq_int_type(c5, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Checks whether a range of characters could be decoded,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true, without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator, class Predicate>
+        static validate_result validate(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return detail::validator<base32, 5, 8, true>::validate(first, last, skip);
+        }
 
-                int_type c6 = seek(first, last, skip);
-                if (traits::eq_int_type(c6, traits::inv())) {
-                    throw invalid_length("base32 decode error");
-                }
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator>
+        static bool is_valid(InputIterator first, InputIterator last)
+        {
+            return validate(first, last).status == decode_ok;
+        }
 
-                *result = (c4 & 0x01) << 7 | c5 << 2 | c6 >> 3;
-                ++result;
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error, ignoring characters not in the encoding
+         * alphabet for which @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator, class Predicate>
+        static bool is_valid(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return validate(first, last, skip).status == decode_ok;
+        }
 
-                int_type c7 = seek(first, last, skip);
-                if (traits::eq_int_type(c7, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is decoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of characters consumed and octets
+         * written, with status codec_done if all input has been
+         * decoded, codec_output_full if the output buffers are too
+         * small, or codec_error if the input is invalid
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            decoder d;
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
+        }
 
-                *result = (c6 & 0x07) << 5 | c7;
-                ++result;
-            }
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as decodev() above, ignoring characters not
+         * in the encoding alphabet for which @a skip evaluates to @c
+         * true.
+         */
+        template<class ConstBuffer, class MutableBuffer, class Predicate>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            Predicate skip
+            )
+        {
+            detail::skipping_decoder<decoder, Predicate> d(skip);
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
         }
 
         /**
@@ -676,6 +1203,36 @@ namespace stlencoders {
             return (n + 7) / 8 * 5;
         }
 
+        /**
+         * Computes the exact length of a character sequence encoded
+         * by encode_wrapped(), including line delimiters.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input octet sequence
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @param pad if @c true, includes padding at the end of the
+         * encoded character sequence
+         *
+         * @return the length of the encoded character sequence
+         */
+        template<class sizeT>
+        static sizeT wrapped_encode_size(
+            sizeT n, std::size_t cols, const char_type* eol,
+            bool pad = true
+            )
+        {
+            return detail::wrapped_size<sizeT>(
+                pad ? (n + 4) / 5 * 8 : n / 5 * 8 + (n % 5 * 8 + 4) / 5, cols,
+                std::char_traits<char_type>::length(eol)
+                );
+        }
+
     private:
         template<class InputIterator, class OutputIterator, class IteratorTag>
         static OutputIterator encode(
@@ -828,6 +1385,255 @@ namespace stlencoders {
             }
         }
 
+    	template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            bool pad, detail::contiguous_iterator_tag
+            )
+        {
+            const unsigned char* src = detail::address<const unsigned char>(first);
+            char_type* dst = detail::address<char_type>(result);
+            return result + (encode_contiguous(src, src + (last - first), dst, pad) - dst);
+        }
+
+        static char_type* encode_contiguous(
+            const unsigned char* first, const unsigned char* last,
+            char_type* result, bool pad
+            )
+        {
+            encode_block(first, last, result, detail::base32_block<traits>());
+
+            const detail::pair_table<traits, 5>& table =
+                detail::pair_table<traits, 5>::instance();
+
+            for (; last - first >= 5; first += 5, result += 8) {
+                const unsigned long long v =
+                    static_cast<unsigned long long>(first[0]) << 32 |
+                    static_cast<unsigned long>(first[1]) << 24 |
+                    static_cast<unsigned long>(first[2]) << 16 |
+                    static_cast<unsigned long>(first[3]) << 8 |
+                    static_cast<unsigned long>(first[4]);
+                std::memcpy(result + 0, table.value[v >> 30 & 0x3ff], sizeof table.value[0]);
+                std::memcpy(result + 2, table.value[v >> 20 & 0x3ff], sizeof table.value[0]);
+                std::memcpy(result + 4, table.value[v >> 10 & 0x3ff], sizeof table.value[0]);
+                std::memcpy(result + 6, table.value[v & 0x3ff], sizeof table.value[0]);
+            }
+
+            return encode(first, last, result, pad, std::random_access_iterator_tag());
+        }
+
+        static void encode_block(
+            const unsigned char*&, const unsigned char*, char_type*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void encode_block(
+            const unsigned char*& first, const unsigned char* last,
+            char_type*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base32_encode_block(
+                first, last - first, reinterpret_cast<char*>(result),
+                detail::base32_block<traits>::encode_table()
+                );
+            first += n;
+            result += n / 5 * 8;
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate, class IteratorTag>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, IteratorTag
+            )
+        {
+            InputIterator p = first;
+            decode_status status = decode(p, last, result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, std::distance(first, p));
+        }
+
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, std::input_iterator_tag
+            )
+        {
+            typedef detail::counting_iterator<InputIterator> iterator;
+            iterator p(first);
+            decode_status status = decode(p, iterator(last), result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, p.count());
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, detail::contiguous_iterator_tag
+            )
+        {
+            const char_type* src = detail::address<const char_type>(first);
+            unsigned char* dst = detail::address<unsigned char>(result);
+            typedef detail::bool_constant<detail::is_skip_set<Predicate>::value> skip_set_tag;
+            decode_result<unsigned char*> r =
+                decode_contiguous(src, src + (last - first), dst, skip, skip_set_tag());
+            return detail::make_decode_result(r.status, result + (r.result - dst), r.offset);
+        }
+
+        template<class Predicate>
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, Predicate& skip, detail::false_type
+            )
+        {
+            const char_type* p = first;
+            decode_status status = decode(p, last, result, skip, detail::true_type());
+            return detail::make_decode_result(status, result, p - first);
+        }
+
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, const skip_set& skip, detail::true_type
+            )
+        {
+            return detail::decode_skip_set<base32>(first, last, result, skip);
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate, bool Contiguous>
+        static decode_status decode(
+            InputIterator& first, const InputIterator& last, OutputIterator& result,
+            Predicate& skip, detail::bool_constant<Contiguous> contiguous
+            )
+        {
+            for (;;) {
+                decode_fast(first, last, result, contiguous);
+
+                int_type c0 = seek(first, last, skip);
+                if (traits::eq_int_type(c0, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                int_type c1 = seek(first, last, skip);
+                if (traits::eq_int_type(c1, traits::inv())) {
+                    return stop(first, last, decode_invalid_length);
+                }
+
+                *result = c0 << 3 | c1 >> 2;
+                ++result;
+
+                int_type c2 = seek(first, last, skip);
+                if (traits::eq_int_type(c2, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                int_type c3 = seek(first, last, skip);
+                if (traits::eq_int_type(c3, traits::inv())) {
+                    return stop(first, last, decode_invalid_length);
+                }
+
+                *result = (c1 & 0x03) << 6 | c2 << 1 | c3 >> 4;
+                ++result;
+
+                int_type c4 = seek(first, last, skip);
+                if (traits::eq_int_type(c4, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                *result = (c3 & 0x0f) << 4 | c4 >> 1;
+                ++result;
+
+                int_type c5 = seek(first, last, skip);
+                if (traits::eq_int_type(c5, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                int_type c6 = seek(first, last, skip);
+                if (traits::eq_int_type(c6, traits::inv())) {
+                    return stop(first, last, decode_invalid_length);
+                }
+
+                *result = (c4 & 0x01) << 7 | c5 << 2 | c6 >> 3;
+                ++result;
+
+                int_type c7 = seek(first, last, skip);
+                if (traits::eq_int_type(c7, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                *result = (c6 & 0x07) << 5 | c7;
+                ++result;
+            }
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static void decode_fast(
+            InputIterator&, const InputIterator&, OutputIterator&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_fast(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            decode_block(first, last, result, detail::base32_block<traits>());
+
+            for (; last - first >= 8; first += 8, result += 5) {
+                const int_type c0 = traits::to_int_type(first[0]);
+                const int_type c1 = traits::to_int_type(first[1]);
+                const int_type c2 = traits::to_int_type(first[2]);
+                const int_type c3 = traits::to_int_type(first[3]);
+                const int_type c4 = traits::to_int_type(first[4]);
+                const int_type c5 = traits::to_int_type(first[5]);
+                const int_type c6 = traits::to_int_type(first[6]);
+                const int_type c7 = traits::to_int_type(first[7]);
+
+                // leave padding, skipped and invalid characters to seek()
+                if ((c0 | c1 | c2 | c3 | c4 | c5 | c6 | c7) & ~0x1f) {
+                    break;
+                }
+
+                const unsigned long long v =
+                    static_cast<unsigned long long>(c0) << 35 |
+                    static_cast<unsigned long long>(c1) << 30 |
+                    static_cast<unsigned long>(c2) << 25 |
+                    static_cast<unsigned long>(c3) << 20 |
+                    static_cast<unsigned long>(c4) << 15 |
+                    static_cast<unsigned long>(c5) << 10 |
+                    static_cast<unsigned long>(c6) << 5 |
+                    static_cast<unsigned long>(c7);
+                const unsigned char buf[5] = {
+                    static_cast<unsigned char>(v >> 32),
+                    static_cast<unsigned char>(v >> 24),
+                    static_cast<unsigned char>(v >> 16),
+                    static_cast<unsigned char>(v >> 8),
+                    static_cast<unsigned char>(v)
+                };
+                std::memcpy(result, buf, sizeof buf);
+            }
+        }
+
+        static void decode_block(
+            const char_type*&, const char_type*, unsigned char*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_block(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base32_decode_block(
+                reinterpret_cast<const char*>(first), last - first, result,
+                detail::base32_block<traits>::alphabet()
+                );
+            first += n;
+            result += n / 8 * 5;
+        }
+
         template<class OutputIterator, class sizeT>
         static OutputIterator pad_n(OutputIterator result, sizeT n) {
             for (; n > 0; --n) {
@@ -843,17 +1649,15 @@ namespace stlencoders {
         {
             while (first != last) {
                 char_type c = *first;
-                ++first;
 
                 int_type v = traits::to_int_type(c);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
                 } else if (skip(c)) {
-                    continue;
-                } else if (traits::eq(c, traits::pad())) {
-                    break;
+                    ++first;
                 } else {
-                    throw invalid_character("base32 decode error");
+                    break;
                 }
             }
 
@@ -866,19 +1670,31 @@ namespace stlencoders {
             )
         {
             if (first != last) {
-                char_type c = *first;
-                ++first;
-
-                int_type v = traits::to_int_type(c);
+                int_type v = traits::to_int_type(*first);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else if (!traits::eq(c, traits::pad())) {
-                    throw invalid_character("base32 decode error");
                 }
             }
 
             return traits::inv();
         }
+
+        /*
+         * Returns status if decoding stopped at the end of the input
+         * or at padding, or decode_invalid_character otherwise.
+         */
+        template<class InputIterator>
+        static decode_status stop(
+            const InputIterator& first, const InputIterator& last,
+            decode_status status
+            )
+        {
+            if (first != last && !traits::eq(*first, traits::pad())) {
+                return decode_invalid_character;
+            }
+            return status;
+        }
     };
 }
 
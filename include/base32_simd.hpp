@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_BASE32_SIMD_HPP
+#define STLENCODERS_BASE32_SIMD_HPP
+
+#include "dispatch.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @file
+ *
+ * Vectorized block kernels for the Base32 encoding scheme.
+ */
+namespace stlencoders {
+    namespace detail {
+        /*
+         * Lookup tables describing a Base32 encoding alphabet.
+         *
+         * encode_upper and encode_lower map 5-bit values to their
+         * uppercase and lowercase character representation.
+         *
+         * A character is not in the alphabet if the entries for its
+         * low and high nibble in decode_lo and decode_hi have a bit
+         * in common.  Otherwise, adding decode_offset[hi] yields its
+         * 5-bit value, so both cases are accepted.
+         */
+        struct base32_simd_alphabet {
+            char encode_upper[33];
+            char encode_lower[33];
+            signed char decode_lo[16];
+            signed char decode_hi[16];
+            signed char decode_offset[16];
+        };
+
+        inline const base32_simd_alphabet& base32_simd_std()
+        {
+            static const base32_simd_alphabet alphabet = {
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567",
+                "abcdefghijklmnopqrstuvwxyz234567",
+                {
+                    0x07, 0x03, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+                    0x03, 0x03, 0x03, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+                },
+                {
+                    0x01, 0x01, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01
+                },
+                {
+                    0, 0, 0, 26 - '2', 0 - 'A', 0 - 'A', 0 - 'a', 0 - 'a',
+                    0, 0, 0, 0, 0, 0, 0, 0
+                }
+            };
+            return alphabet;
+        }
+
+        inline const base32_simd_alphabet& base32_simd_hex()
+        {
+            static const base32_simd_alphabet alphabet = {
+                "0123456789ABCDEFGHIJKLMNOPQRSTUV",
+                "0123456789abcdefghijklmnopqrstuv",
+                {
+                    0x05, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x09,
+                    0x09, 0x09, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+                },
+                {
+                    0x01, 0x01, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                    0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01
+                },
+                {
+                    0, 0, 0, 0 - '0', 10 - 'A', 10 - 'A', 10 - 'a', 10 - 'a',
+                    0, 0, 0, 0, 0, 0, 0, 0
+                }
+            };
+            return alphabet;
+        }
+
+#if defined(STLENCODERS_AVX2)
+        /*
+         * Splits the 40-bit group at the start of each lane into 16
+         * words holding one 5-bit value each.  Every word is loaded
+         * with the two octets containing its value, which is then
+         * shifted into place by a multiplication with a power of two
+         * keeping the high half of the product.
+         */
+        inline STLENCODERS_TARGET_AVX2 __m256i base32_encode_split(__m256i in, __m256i index)
+        {
+            in = _mm256_shuffle_epi8(in, index);
+            in = _mm256_mulhi_epu16(in, _mm256_setr_epi16(
+                1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8,
+                1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8
+                ));
+            return _mm256_and_si256(in, _mm256_set1_epi16(0x1f));
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base32_encode_avx2(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(table)
+                ));
+            const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(table + 16)
+                ));
+            const __m256i first = _mm256_setr_epi8(
+                1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4,
+                1, 0, 1, 0, 2, 1, 2, 1, 3, 2, 4, 3, 4, 3, 5, 4
+                );
+            const __m256i second = _mm256_setr_epi8(
+                6, 5, 6, 5, 7, 6, 7, 6, 8, 7, 9, 8, 9, 8, 10, 9,
+                6, 5, 6, 5, 7, 6, 7, 6, 8, 7, 9, 8, 9, 8, 10, 9
+                );
+            const unsigned char* p = src;
+
+            // each lane loads 16 octets, but only consumes 10
+            for (; n - (p - src) >= 26; p += 20, dst += 32) {
+                __m128i l0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i l1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 10));
+                __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(l0), l1, 1);
+                __m256i v = _mm256_packus_epi16(
+                    base32_encode_split(in, first),
+                    base32_encode_split(in, second)
+                    );
+                __m256i upper = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(15));
+                v = _mm256_blendv_epi8(
+                    _mm256_shuffle_epi8(lo, v), _mm256_shuffle_epi8(hi, v), upper
+                    );
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+            }
+
+            return p - src;
+        }
+
+        /*
+         * Packs the 16 5-bit values in each lane into 10 octets,
+         * stored in the low bytes of the lane.
+         */
+        inline STLENCODERS_TARGET_AVX2 __m256i base32_decode_pack(__m256i in)
+        {
+            in = _mm256_maddubs_epi16(in, _mm256_set1_epi16(0x0120));
+            in = _mm256_madd_epi16(in, _mm256_set1_epi32(0x00010400));
+            in = _mm256_or_si256(
+                _mm256_and_si256(_mm256_slli_epi64(in, 20), _mm256_set1_epi64x(0xffffffffffLL)),
+                _mm256_srli_epi64(in, 32)
+                );
+            return _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+                4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1,
+                4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1
+                ));
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base32_decode_avx2(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base32_simd_alphabet& alphabet
+            )
+        {
+            const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphabet.decode_lo)
+                ));
+            const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphabet.decode_hi)
+                ));
+            const __m256i lut_offset = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphabet.decode_offset)
+                ));
+            const __m256i mask = _mm256_set1_epi8(0x0f);
+            const char* p = src;
+
+            for (; n - (p - src) >= 32; p += 32, dst += 20) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+                __m256i lo = _mm256_and_si256(in, mask);
+                if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo),
+                                        _mm256_shuffle_epi8(lut_hi, hi))) {
+                    break;
+                }
+
+                __m256i out = base32_decode_pack(
+                    _mm256_add_epi8(in, _mm256_shuffle_epi8(lut_offset, hi))
+                    );
+
+                // the low lane's excess octets are overwritten by the
+                // high lane, which must not be stored past dst + 20
+                __m128i out_hi = _mm256_extracti128_si256(out, 1);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                                 _mm256_castsi256_si128(out));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 10), out_hi);
+                short tail = static_cast<short>(_mm_extract_epi16(out_hi, 4));
+                std::memcpy(dst + 18, &tail, 2);
+            }
+
+            return p - src;
+        }
+#endif
+
+        inline std::size_t base32_encode_scalar(
+            const unsigned char*, std::size_t, char*, const char*
+            )
+        {
+            return 0;
+        }
+
+        inline std::size_t base32_decode_scalar(
+            const char*, std::size_t, unsigned char*,
+            const base32_simd_alphabet&
+            )
+        {
+            return 0;
+        }
+
+        struct base32_encode_kernel {
+            typedef std::size_t (*function_type)(
+                const unsigned char*, std::size_t, char*, const char*
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base32_encode_avx2;
+                }
+#endif
+                return base32_encode_scalar;
+            }
+        };
+
+        struct base32_decode_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, unsigned char*,
+                const base32_simd_alphabet&
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base32_decode_avx2;
+                }
+#endif
+                return base32_decode_scalar;
+            }
+        };
+
+        /*
+         * Encodes the longest prefix of [src, src + n) the selected
+         * block kernel can handle using the 32 characters in table,
+         * and returns its length, which is always a multiple of 5.
+         */
+        inline std::size_t base32_encode_block(
+            const unsigned char* src, std::size_t n, char* dst,
+            const char* table
+            )
+        {
+            return dispatch<base32_encode_kernel>::get()(src, n, dst, table);
+        }
+
+        /*
+         * Decodes the longest prefix of [src, src + n) consisting of
+         * complete blocks of encoding characters the selected block
+         * kernel can handle, and returns its length, which is always
+         * a multiple of 8.
+         */
+        inline std::size_t base32_decode_block(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base32_simd_alphabet& alphabet
+            )
+        {
+            return dispatch<base32_decode_kernel>::get()(src, n, dst, alphabet);
+        }
+    }
+}
+
+#endif
@@ -25,10 +25,20 @@
 #ifndef STLENCODERS_BASE64_HPP
 #define STLENCODERS_BASE64_HPP
 
+#include "base64_simd.hpp"
+#include "buffer.hpp"
+#include "chunk.hpp"
+#include "contiguous.hpp"
 #include "error.hpp"
 #include "lookup.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
 #include "traits.hpp"
+#include "validate.hpp"
+#include "wrap.hpp"
 
+#include <cstddef>
+#include <cstring>
 #include <iterator>
 
 /**
@@ -284,6 +294,64 @@ namespace stlencoders {
     : public portable_wchar_encoding_traits<base64url_traits<char> > {
     };
 
+    namespace detail {
+        template<class traits> struct base64_block : false_type { };
+
+        template<>
+        struct base64_block<base64_traits<char> > : true_type {
+            static const base64_simd_alphabet& alphabet() {
+                return base64_simd_std();
+            }
+        };
+
+        template<>
+        struct base64_block<base64url_traits<char> > : true_type {
+            static const base64_simd_alphabet& alphabet() {
+                return base64_simd_url();
+            }
+        };
+
+        /*
+         * Decoding tables for narrow characters, built from the
+         * encoding traits on first use.  value[i][c] holds the 6-bit
+         * value of character c shifted to the position of the i-th
+         * character in a 24-bit group, or the invalid bit if c is not
+         * in the encoding alphabet, so four characters decode by
+         * or-ing four lookups.  category[c] holds the character
+         * class of c.
+         */
+        template<class traits>
+        struct base64_decode_table {
+            enum { invalid = 0x01000000 };
+
+            unsigned int value[4][256];
+            unsigned char category[256];
+
+            base64_decode_table() {
+                for (int i = 0; i != 256; ++i) {
+                    typename traits::char_type c = static_cast<char>(i);
+                    typename traits::int_type v = traits::to_int_type(c);
+
+                    if (!traits::eq_int_type(v, traits::inv())) {
+                        value[0][i] = static_cast<unsigned int>(v) << 18;
+                        value[1][i] = static_cast<unsigned int>(v) << 12;
+                        value[2][i] = static_cast<unsigned int>(v) << 6;
+                        value[3][i] = static_cast<unsigned int>(v);
+                        category[i] = alphabet_class;
+                    } else {
+                        value[0][i] = value[1][i] = value[2][i] = value[3][i] = invalid;
+                        category[i] = traits::eq(c, traits::pad()) ? pad_class : invalid_class;
+                    }
+                }
+            }
+
+            static const base64_decode_table& instance() {
+                static const base64_decode_table table;
+                return table;
+            }
+        };
+    }
+
     /**
      * This class template implements the Base64 encoding as defined
      * in RFC 4648 for a given character type and encoding alphabet.
@@ -307,8 +375,24 @@ namespace stlencoders {
     template<class charT, class traits = base64_traits<charT> >
     class base64 {
     private:
+        template<class, int, int, bool> friend class detail::chunk_decoder;
+
         struct noskip { };
 
+        struct encode_function {
+            explicit encode_function(bool p) : pad(p) { }
+
+            template<class InputIterator, class OutputIterator>
+            OutputIterator operator()(
+                InputIterator first, InputIterator last, OutputIterator result
+                ) const
+            {
+                return encode(first, last, result, pad);
+            }
+
+            bool pad;
+        };
+
     public:
         /**
          * The encoding character type.
@@ -325,6 +409,43 @@ namespace stlencoders {
          */
         typedef typename traits::int_type int_type;
 
+        /**
+         * A stateful encoder for octet ranges that arrive in chunks.
+         *
+         * Successive calls to update() encode their ranges as if they
+         * were one, holding back octets that do not fill a quantum
+         * until the next call.  finish() encodes whatever is left.
+         */
+        class encoder : public detail::chunk_encoder<encode_function, charT, 4, 3> {
+        public:
+            /**
+             * Constructs an encoder.
+             *
+             * @param pad if @c true, finish() performs padding at the
+             * end of the encoded character range
+             */
+            explicit encoder(bool pad = true)
+            : detail::chunk_encoder<encode_function, charT, 4, 3>(encode_function(pad)) { }
+        };
+
+        /**
+         * A stateful decoder for character ranges that arrive in
+         * chunks.
+         *
+         * Successive calls to update() decode their ranges as if they
+         * were one, holding back the characters of an incomplete
+         * quantum until the next call.  finish() decodes whatever is
+         * left, and checks the total number of encoding characters.
+         */
+        class decoder : public detail::chunk_decoder<base64, 6, 4, true> {
+        public:
+            /**
+             * Constructs a decoder.
+             */
+            decoder()
+            : detail::chunk_decoder<base64, 6, 4, true>("base64 decode error") { }
+        };
+
         /**
          * Encodes a range of octets.
          *
@@ -356,10 +477,143 @@ namespace stlencoders {
             bool pad = true
             )
         {
-            typedef typename std::iterator_traits<InputIterator>::iterator_category tag;
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
             return encode(first, last, result, pad, tag());
         }
 
+        /**
+         * Encodes a range of octets, splitting it into chunks of whole
+         * quanta that are encoded concurrently as requested by @a
+         * policy.  Only the last chunk is padded.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the octet range to be encoded
+         *
+         * @param last a random access iterator to the final position
+         * in the octet range to be encoded
+         *
+         * @param result a random access iterator to the encoded
+         * character range
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator encode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, bool pad = true
+            )
+        {
+            return detail::parallel_encode(
+                policy, first, last, result, encode_function(pad), 4, 3
+                );
+        }
+
+        /**
+         * Encodes a range of octets, inserting a line delimiter
+         * between lines of a given number of characters.
+         *
+         * Random access ranges are encoded a line at a time, without
+         * testing each character for the end of a line.  Other ranges
+         * are encoded through a line_wrap_iterator.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to int_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * octet range to be encoded
+         *
+         * @param last an input iterator to the final position in the
+         * octet range to be encoded
+         *
+         * @param result an output iterator to the encoded character
+         * range
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         */
+        template<class InputIterator, class OutputIterator>
+        static OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const char_type* eol,
+            bool pad = true
+            )
+        {
+            return detail::encode_wrapped(
+                first, last, result, cols, eol, encode_function(pad), 4, 3
+                );
+        }
+
+        /**
+         * Encodes a sequence of octet buffers into a sequence of
+         * character buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is encoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @param pad if @c true, performs padding at the end of the
+         * encoded character range
+         *
+         * @return the total number of octets consumed and characters
+         * written, with status codec_done if all input has been
+         * encoded, or codec_output_full if the output buffers are
+         * too small
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result encodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            bool pad = true
+            )
+        {
+            encoder e(pad);
+            return detail::process_buffers<unsigned char, char_type>(
+                e, in, in_count, out, out_count
+                );
+        }
+
         /**
          * Decodes a range of characters.
          *
@@ -439,36 +693,351 @@ namespace stlencoders {
             Predicate skip
             )
         {
-            for (;;) {
-                int_type c0 = seek(first, last, skip);
-                if (traits::eq_int_type(c0, traits::inv())) {
-                    return result;
-                }
+            return detail::decode_result_value(
+                try_decode(first, last, result, skip), "base64 decode error"
+                );
+        }
 
-                int_type c1 = seek(first, last, skip);
-                if (traits::eq_int_type(c1, traits::inv())) {
-                    throw invalid_length("base64 decode error");
-                }
+        /**
+         * Decodes a range of characters, splitting it into chunks of
+         * whole quanta that are decoded concurrently as requested by
+         * @a policy.  Octets may be assigned to the output range
+         * beyond the returned iterator if decoding stops early.
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result
+            )
+        {
+            return detail::decode_result_value(
+                detail::parallel_decode<base64>(policy, first, last, result, 4, 3),
+                "base64 decode error"
+                );
+        }
 
-                *result = c0 << 2 | c1 >> 4;
-                ++result;
+        /**
+         * Decodes a range of characters, splitting it into chunks that
+         * are decoded concurrently as requested by @a policy.  The
+         * alphabet characters of each chunk are counted first, so
+         * that chunk boundaries can be moved to the start of a
+         * quantum.  Octets may be assigned to the output range beyond
+         * the returned iterator if decoding stops early.
+         *
+         * For every character @c c not in the encoding alphabet,
+         * - if @a skip(c) evaluates to @c true, the character is
+         *   ignored
+         * - if @c c equals @c traits::pad(), returns
+         * - otherwise, throws invalid_character
+         *
+         * @tparam RandomAccessIterator an iterator type satisfying
+         * random access iterator requirements and referring to
+         * elements implicitly convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying random
+         * access iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param policy the parallel execution policy
+         *
+         * @param first a random access iterator to the first position
+         * in the character range to be decoded
+         *
+         * @param last a random access iterator to the final position
+         * in the character range to be decoded
+         *
+         * @param result a random access iterator to the decoded octet
+         * range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return an output iterator referring to one past the last
+         * value assigned to the output range
+         *
+         * @throw invalid_character if a character not in the encoding
+         * alphabet is encountered
+         *
+         * @throw invalid_length if the input range contains an
+         * invalid number of encoding characters
+         */
+        template<class RandomAccessIterator, class OutputIterator, class Predicate>
+        static OutputIterator decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last,
+            OutputIterator result, Predicate skip
+            )
+        {
+            typedef detail::validator<base64, 6, 4, true> scanner;
+            return detail::decode_result_value(
+                detail::parallel_decode<base64, scanner>(
+                    policy, first, last, result, skip, 4, 3
+                    ),
+                "base64 decode error"
+                );
+        }
 
-                int_type c2 = seek(first, last, skip);
-                if (traits::eq_int_type(c2, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Decodes a range of characters without throwing exceptions.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result
+            )
+        {
+            return try_decode(first, last, result, noskip());
+        }
 
-                *result = (c1 & 0x0f) << 4 | c2 >> 2;
-                ++result;
+        /**
+         * Decodes a range of characters without throwing exceptions,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam OutputIterator an iterator type satisfying output
+         * iterator requirements
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be decoded
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be decoded
+         *
+         * @param result an output iterator to the decoded octet range
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status of the decode operation, an output
+         * iterator referring to one past the last value assigned to
+         * the output range, and the offset of the character at which
+         * decoding stopped
+         */
+        template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> try_decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate skip
+            )
+        {
+            typedef typename detail::range_category<
+                InputIterator, OutputIterator, char_type
+                >::type tag;
+            return decode(first, last, result, skip, tag());
+        }
 
-                int_type c3 = seek(first, last, skip);
-                if (traits::eq_int_type(c3, traits::inv())) {
-                    return result;
-                }
+        /**
+         * Checks whether a range of characters could be decoded,
+         * without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator>
+        static validate_result validate(InputIterator first, InputIterator last)
+        {
+            detail::skip_none skip;
+            return detail::validator<base64, 6, 4, true>::validate(first, last, skip);
+        }
 
-                *result = (c2 & 0x03) << 6 | c3;
-                ++result;
-            }
+        /**
+         * Checks whether a range of characters could be decoded,
+         * ignoring characters not in the encoding alphabet for which
+         * @a skip evaluates to @c true, without producing any output.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return the status decoding the range would report, and the
+         * offset of the character at which decoding would stop
+         */
+        template<class InputIterator, class Predicate>
+        static validate_result validate(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return detail::validator<base64, 6, 4, true>::validate(first, last, skip);
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator>
+        static bool is_valid(InputIterator first, InputIterator last)
+        {
+            return validate(first, last).status == decode_ok;
+        }
+
+        /**
+         * Checks whether a range of characters can be decoded
+         * without error, ignoring characters not in the encoding
+         * alphabet for which @a skip evaluates to @c true.
+         *
+         * @tparam InputIterator an iterator type satisfying input
+         * iterator requirements and referring to elements implicitly
+         * convertible to char_type
+         *
+         * @tparam Predicate a predicate type
+         *
+         * @param first an input iterator to the first position in the
+         * character range to be validated
+         *
+         * @param last an input iterator to the final position in the
+         * character range to be validated
+         *
+         * @param skip a function object that, when applied to a value
+         * of type char_type, returns a value testable as @c true
+         *
+         * @return @c true if decoding the range would not throw
+         */
+        template<class InputIterator, class Predicate>
+        static bool is_valid(InputIterator first, InputIterator last, Predicate skip)
+        {
+            return validate(first, last, skip).status == decode_ok;
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as if each sequence were contiguous.
+         *
+         * Quanta that straddle buffer boundaries are handled
+         * internally, while the interior of each buffer is decoded
+         * in place.  Buffer sizes are in bytes.
+         *
+         * @tparam ConstBuffer a buffer descriptor type such as
+         * const_buffer or iovec
+         *
+         * @tparam MutableBuffer a buffer descriptor type such as
+         * mutable_buffer or iovec
+         *
+         * @param in an array of input buffers
+         *
+         * @param in_count the number of input buffers
+         *
+         * @param out an array of output buffers
+         *
+         * @param out_count the number of output buffers
+         *
+         * @return the total number of characters consumed and octets
+         * written, with status codec_done if all input has been
+         * decoded, codec_output_full if the output buffers are too
+         * small, or codec_error if the input is invalid
+         */
+        template<class ConstBuffer, class MutableBuffer>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count
+            )
+        {
+            decoder d;
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
+        }
+
+        /**
+         * Decodes a sequence of character buffers into a sequence of
+         * octet buffers, as decodev() above, ignoring characters not
+         * in the encoding alphabet for which @a skip evaluates to @c
+         * true.
+         */
+        template<class ConstBuffer, class MutableBuffer, class Predicate>
+        static codec_result decodev(
+            const ConstBuffer* in, std::size_t in_count,
+            const MutableBuffer* out, std::size_t out_count,
+            Predicate skip
+            )
+        {
+            detail::skipping_decoder<decoder, Predicate> d(skip);
+            return detail::process_buffers<char_type, unsigned char>(
+                d, in, in_count, out, out_count
+                );
         }
 
         /**
@@ -501,6 +1070,36 @@ namespace stlencoders {
             return (n + 3) / 4 * 3;
         }
 
+        /**
+         * Computes the exact length of a character sequence encoded
+         * by encode_wrapped(), including line delimiters.
+         *
+         * @tparam sizeT an integral type
+         *
+         * @param n the length of the input octet sequence
+         *
+         * @param cols the number of characters per line, or 0 to
+         * disable line wrapping
+         *
+         * @param eol the null-terminated line delimiter
+         *
+         * @param pad if @c true, includes padding at the end of the
+         * encoded character sequence
+         *
+         * @return the length of the encoded character sequence
+         */
+        template<class sizeT>
+        static sizeT wrapped_encode_size(
+            sizeT n, std::size_t cols, const char_type* eol,
+            bool pad = true
+            )
+        {
+            return detail::wrapped_size<sizeT>(
+                pad ? (n + 2) / 3 * 4 : n / 3 * 4 + (n % 3 * 4 + 2) / 3, cols,
+                std::char_traits<char_type>::length(eol)
+                );
+        }
+
     private:
     	template<class InputIterator, class OutputIterator, class IteratorTag>
         static OutputIterator encode(
@@ -582,6 +1181,224 @@ namespace stlencoders {
             }
         }
 
+    	template<class InputIterator, class OutputIterator>
+        static OutputIterator encode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            bool pad, detail::contiguous_iterator_tag
+            )
+        {
+            const unsigned char* src = detail::address<const unsigned char>(first);
+            char_type* dst = detail::address<char_type>(result);
+            return result + (encode_contiguous(src, src + (last - first), dst, pad) - dst);
+        }
+
+        static char_type* encode_contiguous(
+            const unsigned char* first, const unsigned char* last,
+            char_type* result, bool pad
+            )
+        {
+            encode_block(first, last, result, detail::base64_block<traits>());
+
+            const detail::pair_table<traits, 6>& table =
+                detail::pair_table<traits, 6>::instance();
+
+            for (; last - first >= 6; first += 6, result += 8) {
+                const unsigned long long v =
+                    static_cast<unsigned long long>(first[0]) << 40 |
+                    static_cast<unsigned long long>(first[1]) << 32 |
+                    static_cast<unsigned long>(first[2]) << 24 |
+                    static_cast<unsigned long>(first[3]) << 16 |
+                    static_cast<unsigned long>(first[4]) << 8 |
+                    static_cast<unsigned long>(first[5]);
+                std::memcpy(result + 0, table.value[v >> 36 & 0xfff], sizeof table.value[0]);
+                std::memcpy(result + 2, table.value[v >> 24 & 0xfff], sizeof table.value[0]);
+                std::memcpy(result + 4, table.value[v >> 12 & 0xfff], sizeof table.value[0]);
+                std::memcpy(result + 6, table.value[v & 0xfff], sizeof table.value[0]);
+            }
+
+            return encode(first, last, result, pad, std::random_access_iterator_tag());
+        }
+
+        static void encode_block(
+            const unsigned char*&, const unsigned char*, char_type*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void encode_block(
+            const unsigned char*& first, const unsigned char* last,
+            char_type*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base64_encode_block(
+                first, last - first, reinterpret_cast<char*>(result),
+                detail::base64_block<traits>::alphabet()
+                );
+            first += n;
+            result += n / 3 * 4;
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate, class IteratorTag>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, IteratorTag
+            )
+        {
+            InputIterator p = first;
+            decode_status status = decode(p, last, result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, std::distance(first, p));
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, std::input_iterator_tag
+            )
+        {
+            typedef detail::counting_iterator<InputIterator> iterator;
+            iterator p(first);
+            decode_status status = decode(p, iterator(last), result, skip, detail::false_type());
+            return detail::make_decode_result(status, result, p.count());
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate>
+        static decode_result<OutputIterator> decode(
+            InputIterator first, InputIterator last, OutputIterator result,
+            Predicate& skip, detail::contiguous_iterator_tag
+            )
+        {
+            const char_type* src = detail::address<const char_type>(first);
+            unsigned char* dst = detail::address<unsigned char>(result);
+            typedef detail::bool_constant<detail::is_skip_set<Predicate>::value> skip_set_tag;
+            decode_result<unsigned char*> r =
+                decode_contiguous(src, src + (last - first), dst, skip, skip_set_tag());
+            return detail::make_decode_result(r.status, result + (r.result - dst), r.offset);
+        }
+
+        template<class Predicate>
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, Predicate& skip, detail::false_type
+            )
+        {
+            const char_type* p = first;
+            decode_status status = decode(p, last, result, skip, detail::true_type());
+            return detail::make_decode_result(status, result, p - first);
+        }
+
+        static decode_result<unsigned char*> decode_contiguous(
+            const char_type* first, const char_type* last,
+            unsigned char* result, const skip_set& skip, detail::true_type
+            )
+        {
+            return detail::decode_skip_set<base64>(first, last, result, skip);
+        }
+
+    	template<class InputIterator, class OutputIterator, class Predicate, bool Contiguous>
+        static decode_status decode(
+            InputIterator& first, const InputIterator& last, OutputIterator& result,
+            Predicate& skip, detail::bool_constant<Contiguous> contiguous
+            )
+        {
+            for (;;) {
+                decode_fast(first, last, result, contiguous);
+
+                int_type c0 = seek(first, last, skip, contiguous);
+                if (traits::eq_int_type(c0, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                int_type c1 = seek(first, last, skip, contiguous);
+                if (traits::eq_int_type(c1, traits::inv())) {
+                    return stop(first, last, decode_invalid_length);
+                }
+
+                *result = c0 << 2 | c1 >> 4;
+                ++result;
+
+                int_type c2 = seek(first, last, skip, contiguous);
+                if (traits::eq_int_type(c2, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                *result = (c1 & 0x0f) << 4 | c2 >> 2;
+                ++result;
+
+                int_type c3 = seek(first, last, skip, contiguous);
+                if (traits::eq_int_type(c3, traits::inv())) {
+                    return stop(first, last, decode_ok);
+                }
+
+                *result = (c2 & 0x03) << 6 | c3;
+                ++result;
+            }
+        }
+
+        template<class InputIterator, class OutputIterator>
+        static void decode_fast(
+            InputIterator&, const InputIterator&, OutputIterator&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_fast(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            decode_block(first, last, result, detail::base64_block<traits>());
+
+            const detail::base64_decode_table<traits>& table =
+                detail::base64_decode_table<traits>::instance();
+
+            for (; last - first >= 8; first += 8, result += 6) {
+                const unsigned char* p = reinterpret_cast<const unsigned char*>(first);
+                const unsigned int hi =
+                    table.value[0][p[0]] | table.value[1][p[1]] |
+                    table.value[2][p[2]] | table.value[3][p[3]];
+                const unsigned int lo =
+                    table.value[0][p[4]] | table.value[1][p[5]] |
+                    table.value[2][p[6]] | table.value[3][p[7]];
+
+                // leave padding, skipped and invalid characters to seek()
+                if ((hi | lo) & detail::base64_decode_table<traits>::invalid) {
+                    break;
+                }
+
+                const unsigned char buf[6] = {
+                    static_cast<unsigned char>(hi >> 16),
+                    static_cast<unsigned char>(hi >> 8),
+                    static_cast<unsigned char>(hi),
+                    static_cast<unsigned char>(lo >> 16),
+                    static_cast<unsigned char>(lo >> 8),
+                    static_cast<unsigned char>(lo)
+                };
+                std::memcpy(result, buf, sizeof buf);
+            }
+        }
+
+        static void decode_block(
+            const char_type*&, const char_type*, unsigned char*&,
+            detail::false_type
+            )
+        {
+        }
+
+        static void decode_block(
+            const char_type*& first, const char_type* last,
+            unsigned char*& result, detail::true_type
+            )
+        {
+            std::size_t n = detail::base64_decode_block(
+                reinterpret_cast<const char*>(first), last - first, result,
+                detail::base64_block<traits>::alphabet()
+                );
+            first += n;
+            result += n / 4 * 3;
+        }
+
         template<class OutputIterator, class sizeT>
         static OutputIterator pad_n(OutputIterator result, sizeT n) {
             for (; n > 0; --n) {
@@ -590,24 +1407,28 @@ namespace stlencoders {
             return result;
         }
 
+        /*
+         * Returns the value of the next character not to be skipped,
+         * or inv() at the end of the input.  Padding and invalid
+         * characters are not consumed, but left to stop().
+         */
         template<class InputIterator, class Predicate>
         static int_type seek(
-            InputIterator& first, const InputIterator& last, Predicate& skip
+            InputIterator& first, const InputIterator& last, Predicate& skip,
+            detail::false_type
             )
         {
             while (first != last) {
                 char_type c = *first;
-                ++first;
 
                 int_type v = traits::to_int_type(c);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
                 } else if (skip(c)) {
-                    continue;
-                } else if (traits::eq(c, traits::pad())) {
-                    break;
+                    ++first;
                 } else {
-                    throw invalid_character("base64 decode error");
+                    break;
                 }
             }
 
@@ -616,23 +1437,81 @@ namespace stlencoders {
 
         template<class InputIterator>
         static int_type seek(
-            InputIterator& first, const InputIterator& last, noskip&
+            InputIterator& first, const InputIterator& last, noskip&,
+            detail::false_type
             )
         {
             if (first != last) {
-                char_type c = *first;
-                ++first;
-
-                int_type v = traits::to_int_type(c);
+                int_type v = traits::to_int_type(*first);
                 if (!traits::eq_int_type(v, traits::inv())) {
+                    ++first;
                     return v;
-                } else if (!traits::eq(c, traits::pad())) {
-                    throw invalid_character("base64 decode error");
                 }
             }
 
             return traits::inv();
         }
+
+        template<class Predicate>
+        static int_type seek(
+            const char_type*& first, const char_type* last, Predicate& skip,
+            detail::true_type
+            )
+        {
+            const detail::base64_decode_table<traits>& table =
+                detail::base64_decode_table<traits>::instance();
+
+            while (first != last) {
+                const unsigned char c = *first;
+
+                if (table.category[c] == detail::alphabet_class) {
+                    ++first;
+                    return table.value[3][c];
+                } else if (skip(char_type(c))) {
+                    ++first;
+                } else {
+                    break;
+                }
+            }
+
+            return traits::inv();
+        }
+
+        static int_type seek(
+            const char_type*& first, const char_type* last, noskip&,
+            detail::true_type
+            )
+        {
+            const detail::base64_decode_table<traits>& table =
+                detail::base64_decode_table<traits>::instance();
+
+            if (first != last) {
+                const unsigned char c = *first;
+
+                if (table.category[c] == detail::alphabet_class) {
+                    ++first;
+                    return table.value[3][c];
+                }
+            }
+
+            return traits::inv();
+        }
+
+        /*
+         * Returns status if decoding stopped at the end of the input
+         * or at padding, or decode_invalid_character otherwise.
+         */
+        template<class InputIterator>
+        static decode_status stop(
+            const InputIterator& first, const InputIterator& last,
+            decode_status status
+            )
+        {
+            if (first != last && !traits::eq(*first, traits::pad())) {
+                return decode_invalid_character;
+            }
+            return status;
+        }
     };
 }
 
@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_BASE64_SIMD_HPP
+#define STLENCODERS_BASE64_SIMD_HPP
+
+#include "dispatch.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+/**
+ * @file
+ *
+ * Vectorized block kernels for the Base64 encoding scheme.
+ */
+namespace stlencoders {
+    namespace detail {
+        /*
+         * Lookup tables describing a Base64 encoding alphabet that
+         * agrees with the standard alphabet for the values 0-61.
+         *
+         * encode_offset maps the class of a 6-bit value, as computed
+         * by base64_encode_translate(), to the offset that has to be
+         * added to the value to obtain its character representation.
+         *
+         * A character is not in the alphabet if the entries for its
+         * low and high nibble in decode_lo and decode_hi have a bit
+         * in common.  Otherwise, adding decode_offset[hi], and
+         * decode_delta if the character equals decode_special,
+         * yields its 6-bit value.
+         *
+         * encode_table and decode_table hold the full mappings, with
+         * -1 denoting characters not in the alphabet.
+         */
+        struct base64_simd_alphabet {
+            signed char encode_offset[16];
+            signed char decode_lo[16];
+            signed char decode_hi[16];
+            signed char decode_offset[16];
+            char decode_special;
+            signed char decode_delta;
+            char encode_table[65];
+            signed char decode_table[128];
+        };
+
+        inline const base64_simd_alphabet& base64_simd_std()
+        {
+            static const base64_simd_alphabet alphabet = {
+                {
+                    'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                    '/' - 63, 'A', 0, 0
+                },
+                {
+                    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a
+                },
+                {
+                    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+                },
+                {
+                    0, 0, 62 - '+', 52 - '0', 0 - 'A', 0 - 'A', 26 - 'a', 26 - 'a',
+                    0, 0, 0, 0, 0, 0, 0, 0
+                },
+                '/', (63 - '/') - (62 - '+'),
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+                {
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+                    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+                    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+                    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+                    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+                }
+            };
+            return alphabet;
+        }
+
+        inline const base64_simd_alphabet& base64_simd_url()
+        {
+            static const base64_simd_alphabet alphabet = {
+                {
+                    'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                    '0' - 52, '0' - 52, '0' - 52, '-' - 62,
+                    '_' - 63, 'A', 0, 0
+                },
+                {
+                    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x11, 0x13, 0x3b, 0x3b, 0x3a, 0x3b, 0x33
+                },
+                {
+                    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x20,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+                },
+                {
+                    0, 0, 62 - '-', 52 - '0', 0 - 'A', 0 - 'A', 26 - 'a', 26 - 'a',
+                    0, 0, 0, 0, 0, 0, 0, 0
+                },
+                '_', (63 - '_') - (0 - 'A'),
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+                {
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1,
+                    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+                    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, 63,
+                    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+                    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+                }
+            };
+            return alphabet;
+        }
+
+#if defined(STLENCODERS_SSSE3)
+        /*
+         * Splits 4 groups of 3 octets into 16 bytes holding one 6-bit
+         * value each.
+         */
+        inline STLENCODERS_TARGET_SSSE3 __m128i base64_encode_split(__m128i in)
+        {
+            in = _mm_shuffle_epi8(in, _mm_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+                ));
+            __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+            __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+            __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+            __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+            return _mm_or_si128(t1, t3);
+        }
+
+        /*
+         * Maps 16 6-bit values to their character representation.
+         */
+        inline STLENCODERS_TARGET_SSSE3 __m128i base64_encode_translate(__m128i in, __m128i offset)
+        {
+            __m128i cls = _mm_subs_epu8(in, _mm_set1_epi8(51));
+            __m128i lt26 = _mm_cmpgt_epi8(_mm_set1_epi8(26), in);
+            cls = _mm_or_si128(cls, _mm_and_si128(lt26, _mm_set1_epi8(13)));
+            return _mm_add_epi8(in, _mm_shuffle_epi8(offset, cls));
+        }
+
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base64_encode_ssse3(
+            const unsigned char* src, std::size_t n, char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const __m128i offset = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphabet.encode_offset)
+                );
+            const unsigned char* p = src;
+
+            // 16 octets are loaded, but only 12 are consumed
+            for (; n - (p - src) >= 28; p += 24, dst += 32) {
+                __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+                lo = base64_encode_translate(base64_encode_split(lo), offset);
+                hi = base64_encode_translate(base64_encode_split(hi), offset);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), lo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), hi);
+            }
+
+            for (; n - (p - src) >= 16; p += 12, dst += 16) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                in = base64_encode_translate(base64_encode_split(in), offset);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), in);
+            }
+
+            return p - src;
+        }
+
+        /*
+         * Loads the decoding tables of an alphabet.
+         */
+        struct base64_decode_tables {
+            __m128i lo;
+            __m128i hi;
+            __m128i offset;
+            __m128i special;
+            __m128i delta;
+
+            STLENCODERS_TARGET_SSSE3
+            explicit base64_decode_tables(const base64_simd_alphabet& alphabet)
+            : lo(load(alphabet.decode_lo)),
+              hi(load(alphabet.decode_hi)),
+              offset(load(alphabet.decode_offset)),
+              special(_mm_set1_epi8(alphabet.decode_special)),
+              delta(_mm_set1_epi8(alphabet.decode_delta))
+            {
+            }
+
+            STLENCODERS_TARGET_SSSE3
+            static __m128i load(const signed char* p) {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            }
+        };
+
+        /*
+         * Packs 16 bytes holding one 6-bit value each into 12
+         * octets.
+         */
+        inline STLENCODERS_TARGET_SSSE3 __m128i base64_decode_pack(__m128i in)
+        {
+            in = _mm_maddubs_epi16(in, _mm_set1_epi32(0x01400140));
+            in = _mm_madd_epi16(in, _mm_set1_epi32(0x00011000));
+            return _mm_shuffle_epi8(in, _mm_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+                ));
+        }
+
+        inline STLENCODERS_TARGET_SSSE3 std::size_t base64_decode_ssse3(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const base64_decode_tables t(alphabet);
+            const __m128i mask = _mm_set1_epi8(0x0f);
+            const char* p = src;
+
+            for (; n - (p - src) >= 16; p += 16, dst += 12) {
+                __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), mask);
+                __m128i lo = _mm_and_si128(in, mask);
+                __m128i err = _mm_and_si128(
+                    _mm_shuffle_epi8(t.lo, lo), _mm_shuffle_epi8(t.hi, hi)
+                    );
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(err, _mm_setzero_si128())) != 0xffff) {
+                    break;
+                }
+
+                __m128i offset = _mm_add_epi8(
+                    _mm_shuffle_epi8(t.offset, hi),
+                    _mm_and_si128(_mm_cmpeq_epi8(in, t.special), t.delta)
+                    );
+                __m128i out = base64_decode_pack(_mm_add_epi8(in, offset));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), out);
+                int tail = _mm_cvtsi128_si32(_mm_srli_si128(out, 8));
+                std::memcpy(dst + 8, &tail, 4);
+            }
+
+            return p - src;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX2)
+        inline STLENCODERS_TARGET_AVX2 __m256i base64_encode_split(__m256i in)
+        {
+            in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+                ));
+            __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+            __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+            __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+            __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+            return _mm256_or_si256(t1, t3);
+        }
+
+        inline STLENCODERS_TARGET_AVX2 __m256i base64_encode_translate(__m256i in, __m256i offset)
+        {
+            __m256i cls = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+            __m256i lt26 = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), in);
+            cls = _mm256_or_si256(cls, _mm256_and_si256(lt26, _mm256_set1_epi8(13)));
+            return _mm256_add_epi8(in, _mm256_shuffle_epi8(offset, cls));
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base64_encode_avx2(
+            const unsigned char* src, std::size_t n, char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const __m256i offset = _mm256_broadcastsi128_si256(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(alphabet.encode_offset)
+                ));
+            const unsigned char* p = src;
+
+            // each lane loads 16 octets, but only consumes 12
+            for (; n - (p - src) >= 28; p += 24, dst += 32) {
+                __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12));
+                __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+                in = base64_encode_translate(base64_encode_split(in), offset);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), in);
+            }
+
+            return (p - src) + base64_encode_ssse3(p, n - (p - src), dst, alphabet);
+        }
+
+        inline STLENCODERS_TARGET_AVX2 __m256i base64_decode_pack(__m256i in)
+        {
+            in = _mm256_maddubs_epi16(in, _mm256_set1_epi32(0x01400140));
+            in = _mm256_madd_epi16(in, _mm256_set1_epi32(0x00011000));
+            in = _mm256_shuffle_epi8(in, _mm256_setr_epi8(
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+                ));
+            return _mm256_permutevar8x32_epi32(in, _mm256_setr_epi32(
+                0, 1, 2, 4, 5, 6, 3, 7
+                ));
+        }
+
+        inline STLENCODERS_TARGET_AVX2 std::size_t base64_decode_avx2(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const base64_decode_tables t(alphabet);
+            const __m256i lut_lo = _mm256_broadcastsi128_si256(t.lo);
+            const __m256i lut_hi = _mm256_broadcastsi128_si256(t.hi);
+            const __m256i lut_offset = _mm256_broadcastsi128_si256(t.offset);
+            const __m256i special = _mm256_broadcastsi128_si256(t.special);
+            const __m256i delta = _mm256_broadcastsi128_si256(t.delta);
+            const __m256i mask = _mm256_set1_epi8(0x0f);
+            const char* p = src;
+
+            for (; n - (p - src) >= 32; p += 32, dst += 24) {
+                __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask);
+                __m256i lo = _mm256_and_si256(in, mask);
+                if (!_mm256_testz_si256(_mm256_shuffle_epi8(lut_lo, lo),
+                                        _mm256_shuffle_epi8(lut_hi, hi))) {
+                    break;
+                }
+
+                __m256i offset = _mm256_add_epi8(
+                    _mm256_shuffle_epi8(lut_offset, hi),
+                    _mm256_and_si256(_mm256_cmpeq_epi8(in, special), delta)
+                    );
+                __m256i out = base64_decode_pack(_mm256_add_epi8(in, offset));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                                 _mm256_castsi256_si128(out));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 16),
+                                 _mm256_extracti128_si256(out, 1));
+            }
+
+            return (p - src) + base64_decode_ssse3(p, n - (p - src), dst, alphabet);
+        }
+#endif
+
+#if defined(STLENCODERS_AVX512)
+        inline STLENCODERS_TARGET_AVX512 __mmask64 base64_mask(std::size_t n)
+        {
+            return n < 64 ? (__mmask64(1) << n) - 1 : ~__mmask64(0);
+        }
+
+        inline STLENCODERS_TARGET_AVX512 std::size_t base64_encode_avx512(
+            const unsigned char* src, std::size_t n, char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const __m512i table = _mm512_loadu_si512(alphabet.encode_table);
+            const __m512i split = _mm512_setr_epi32(
+                0x01020001, 0x04050304, 0x07080607, 0x0a0b090a,
+                0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+                0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+                0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e
+                );
+            const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+            const unsigned char* p = src;
+
+            // the final, partial block uses masked loads and stores
+            for (std::size_t k = n - n % 3; p != src + k; ) {
+                std::size_t m = std::min<std::size_t>(src + k - p, 48);
+                __m512i in = _mm512_maskz_loadu_epi8(base64_mask(m), p);
+                in = _mm512_maskz_permutexvar_epi8(~__mmask64(0), split, in);
+                in = _mm512_maskz_multishift_epi64_epi8(~__mmask64(0), shifts, in);
+                in = _mm512_maskz_permutexvar_epi8(~__mmask64(0), in, table);
+                _mm512_mask_storeu_epi8(dst, base64_mask(m / 3 * 4), in);
+                p += m;
+                dst += m / 3 * 4;
+            }
+
+            return p - src;
+        }
+
+        inline STLENCODERS_TARGET_AVX512 std::size_t base64_decode_avx512(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            const __m512i lo = _mm512_loadu_si512(alphabet.decode_table);
+            const __m512i hi = _mm512_loadu_si512(alphabet.decode_table + 64);
+            const __m512i pack = _mm512_setr_epi32(
+                0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112,
+                0x191a1415, 0x1c1d1e18, 0x26202122, 0x292a2425,
+                0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38,
+                0x3f3f3f3f, 0x3f3f3f3f, 0x3f3f3f3f, 0x3f3f3f3f
+                );
+            const char* p = src;
+
+            while (p != src + n) {
+                std::size_t m = std::min<std::size_t>(src + n - p, 64);
+                __m512i in = _mm512_maskz_loadu_epi8(base64_mask(m), p);
+                __m512i v = _mm512_permutex2var_epi8(lo, in, hi);
+                __mmask64 err = _mm512_movepi8_mask(_mm512_or_si512(v, in));
+
+                // only decode complete quanta preceding the first error
+                err |= ~base64_mask(m);
+                if (err != 0) {
+                    m = ctz64(err) & ~std::size_t(3);
+                }
+
+                v = _mm512_maddubs_epi16(v, _mm512_set1_epi32(0x01400140));
+                v = _mm512_madd_epi16(v, _mm512_set1_epi32(0x00011000));
+                v = _mm512_maskz_permutexvar_epi8(~__mmask64(0), pack, v);
+                _mm512_mask_storeu_epi8(dst, base64_mask(m / 4 * 3), v);
+                p += m;
+                dst += m / 4 * 3;
+
+                if (err != 0) {
+                    break;
+                }
+            }
+
+            return p - src;
+        }
+#endif
+
+        inline std::size_t base64_encode_scalar(
+            const unsigned char*, std::size_t, char*,
+            const base64_simd_alphabet&
+            )
+        {
+            return 0;
+        }
+
+        inline std::size_t base64_decode_scalar(
+            const char*, std::size_t, unsigned char*,
+            const base64_simd_alphabet&
+            )
+        {
+            return 0;
+        }
+
+        struct base64_encode_kernel {
+            typedef std::size_t (*function_type)(
+                const unsigned char*, std::size_t, char*,
+                const base64_simd_alphabet&
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base64_encode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base64_encode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base64_encode_ssse3;
+                }
+#endif
+                return base64_encode_scalar;
+            }
+        };
+
+        struct base64_decode_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, unsigned char*,
+                const base64_simd_alphabet&
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return base64_decode_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return base64_decode_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return base64_decode_ssse3;
+                }
+#endif
+                return base64_decode_scalar;
+            }
+        };
+
+        /*
+         * Encodes the longest prefix of [src, src + n) the selected
+         * block kernel can handle, and returns its length, which is
+         * always a multiple of 3.
+         */
+        inline std::size_t base64_encode_block(
+            const unsigned char* src, std::size_t n, char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            return dispatch<base64_encode_kernel>::get()(src, n, dst, alphabet);
+        }
+
+        /*
+         * Decodes the longest prefix of [src, src + n) consisting of
+         * complete blocks of encoding characters the selected block
+         * kernel can handle, and returns its length, which is always
+         * a multiple of 4.
+         */
+        inline std::size_t base64_decode_block(
+            const char* src, std::size_t n, unsigned char* dst,
+            const base64_simd_alphabet& alphabet
+            )
+        {
+            return dispatch<base64_decode_kernel>::get()(src, n, dst, alphabet);
+        }
+    }
+}
+
+#endif
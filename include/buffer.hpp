@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_BUFFER_HPP
+#define STLENCODERS_BUFFER_HPP
+
+#include "chunk.hpp"
+
+#include <cstddef>
+
+#if defined(__has_include)
+# if __has_include(<sys/uio.h>)
+#  define STLENCODERS_IOVEC 1
+#  include <sys/uio.h>
+# endif
+#endif
+
+/**
+ * @file
+ *
+ * Scatter/gather buffer descriptors.
+ */
+namespace stlencoders {
+    /**
+     * A non-modifiable buffer of @a size bytes at @a data.
+     */
+    struct const_buffer {
+        const void* data;
+        std::size_t size;
+    };
+
+    /**
+     * A modifiable buffer of @a size bytes at @a data.
+     */
+    struct mutable_buffer {
+        void* data;
+        std::size_t size;
+    };
+
+    /**
+     * Returns the address of a buffer.
+     */
+    inline const void* buffer_data(const const_buffer& b) {
+        return b.data;
+    }
+
+    /**
+     * Returns the address of a buffer.
+     */
+    inline void* buffer_data(const mutable_buffer& b) {
+        return b.data;
+    }
+
+    /**
+     * Returns the size of a buffer in bytes.
+     */
+    inline std::size_t buffer_size(const const_buffer& b) {
+        return b.size;
+    }
+
+    /**
+     * Returns the size of a buffer in bytes.
+     */
+    inline std::size_t buffer_size(const mutable_buffer& b) {
+        return b.size;
+    }
+
+#if defined(STLENCODERS_IOVEC)
+    /**
+     * Returns the address of a POSIX I/O vector element.
+     */
+    inline void* buffer_data(const iovec& v) {
+        return v.iov_base;
+    }
+
+    /**
+     * Returns the size of a POSIX I/O vector element in bytes.
+     */
+    inline std::size_t buffer_size(const iovec& v) {
+        return v.iov_len;
+    }
+#endif
+
+    namespace detail {
+        /*
+         * Adapts a decoder to apply a skip predicate in process().
+         */
+        template<class Decoder, class Predicate>
+        class skipping_decoder {
+        public:
+            explicit skipping_decoder(Predicate skip) : skip_(skip) { }
+
+            template<class T, class U>
+            codec_result process(
+                const T* in, std::size_t in_size,
+                U* out, std::size_t out_size,
+                bool final
+                )
+            {
+                return decoder_.process(in, in_size, out, out_size, final, skip_);
+            }
+
+        private:
+            Decoder decoder_;
+            Predicate skip_;
+        };
+
+        /*
+         * Runs coder over a sequence of input buffers holding
+         * elements of type InT into a sequence of output buffers
+         * holding elements of type OutT, as if both were contiguous.
+         * Buffer sizes are in bytes, and are rounded down to whole
+         * elements.  The counts returned are totals over all
+         * buffers.
+         */
+        template<class InT, class OutT, class Coder, class InBuffer, class OutBuffer>
+        codec_result process_buffers(
+            Coder& coder,
+            const InBuffer* in, std::size_t in_count,
+            const OutBuffer* out, std::size_t out_count
+            )
+        {
+            std::size_t last = in_count;
+            while (last != 0 && buffer_size(in[last - 1]) < sizeof(InT)) {
+                --last;
+            }
+
+            std::size_t i = 0, ipos = 0, consumed = 0;
+            std::size_t j = 0, jpos = 0, produced = 0;
+
+            for (;;) {
+                while (i != last && ipos == buffer_size(in[i]) / sizeof(InT)) {
+                    ++i;
+                    ipos = 0;
+                }
+                while (j != out_count && jpos == buffer_size(out[j]) / sizeof(OutT)) {
+                    ++j;
+                    jpos = 0;
+                }
+
+                const InT* first = 0;
+                std::size_t n = 0;
+                if (i != last) {
+                    first = static_cast<const InT*>(buffer_data(in[i])) + ipos;
+                    n = buffer_size(in[i]) / sizeof(InT) - ipos;
+                }
+
+                OutT* result = 0;
+                std::size_t m = 0;
+                if (j != out_count) {
+                    result = static_cast<OutT*>(buffer_data(out[j])) + jpos;
+                    m = buffer_size(out[j]) / sizeof(OutT) - jpos;
+                }
+
+                codec_result r = coder.process(first, n, result, m, i + 1 >= last);
+                ipos += r.consumed;
+                consumed += r.consumed;
+                jpos += r.produced;
+                produced += r.produced;
+
+                switch (r.status) {
+                case codec_need_input:
+                    break;
+                case codec_output_full:
+                    if (j == out_count) {
+                        return make_codec_result(r.status, consumed, produced);
+                    }
+                    break;
+                default:
+                    return make_codec_result(r.status, consumed, produced);
+                }
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,759 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_CHUNK_HPP
+#define STLENCODERS_CHUNK_HPP
+
+#include "contiguous.hpp"
+#include "error.hpp"
+#include "parallel.hpp"
+#include "validate.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+/**
+ * @file
+ *
+ * Common implementation of stateful encoders and decoders.
+ */
+namespace stlencoders {
+    /**
+     * Status codes reported by the bounded process() member
+     * functions of stateful encoders and decoders.
+     */
+    enum codec_status {
+        /**
+         * All input has been consumed, and all output produced so
+         * far has been written; more input may follow.
+         */
+        codec_need_input,
+
+        /**
+         * The output range is full; call again with more room.
+         */
+        codec_output_full,
+
+        /**
+         * The final input has been consumed and all output has been
+         * written; the encoder or decoder has been reset.
+         */
+        codec_done,
+
+        /**
+         * The input is not valid; the encoder or decoder has been
+         * reset.
+         */
+        codec_error
+    };
+
+    /**
+     * The result of a call to a bounded process() member function.
+     */
+    struct codec_result {
+        /**
+         * The status of the encoder or decoder.
+         */
+        codec_status status;
+
+        /**
+         * The number of input elements consumed.  If status is
+         * codec_error, the offset of the offending element, or the
+         * length of the input if the total length was invalid.
+         */
+        std::size_t consumed;
+
+        /**
+         * The number of output elements written.
+         */
+        std::size_t produced;
+    };
+
+    namespace detail {
+        inline codec_result make_codec_result(
+            codec_status status, std::size_t consumed, std::size_t produced
+            )
+        {
+            codec_result r = { status, consumed, produced };
+            return r;
+        }
+
+        /*
+         * Encodes a sequence of octet ranges as if they were one,
+         * holding back up to Octets - 1 octets that do not fill a
+         * quantum until the next call to update() or finish().
+         * Whole quanta are passed to encoder in place, so contiguous
+         * chunks take the codec's block path.  process() also holds
+         * back the encoded characters of one quantum that do not fit
+         * into the output range.
+         */
+        template<class Encoder, class charT, std::size_t Chars, std::size_t Octets>
+        class chunk_encoder {
+        public:
+            explicit chunk_encoder(Encoder encoder)
+            : encoder_(encoder), size_(0), pos_(0), end_(0), finished_(false) { }
+
+            /**
+             * Encodes a range of octets, continuing any quantum left
+             * incomplete by a previous call.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             */
+            template<class InputIterator, class OutputIterator>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result
+                )
+            {
+                typename std::iterator_traits<InputIterator>::iterator_category tag;
+                return update(first, last, result, tag);
+            }
+
+            /**
+             * Encodes a range of octets, continuing any quantum left
+             * incomplete by a previous call, and splitting the whole
+             * quanta that follow into chunks that are encoded
+             * concurrently as requested by @a policy.  Both @a first
+             * and @a result must be random access iterators.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             */
+            template<class RandomAccessIterator, class OutputIterator>
+            OutputIterator update(
+                const parallel_policy& policy,
+                RandomAccessIterator first, RandomAccessIterator last,
+                OutputIterator result
+                )
+            {
+                if (Octets != 1 && size_ != 0) {
+                    for (; size_ != Octets; ++first, ++size_) {
+                        if (first == last) {
+                            return result;
+                        }
+                        buf_[size_] = *first;
+                    }
+                    result = encoder_(buf_, buf_ + Octets, result);
+                    size_ = 0;
+                }
+
+                RandomAccessIterator mid = first + (last - first) / Octets * Octets;
+                result = parallel_encode(policy, first, mid, result, encoder_, Chars, Octets);
+
+                for (; mid != last; ++mid) {
+                    buf_[size_++] = *mid;
+                }
+                return result;
+            }
+
+            /**
+             * Encodes the octets held back by previous calls to
+             * update(), performing padding if requested, and resets
+             * the encoder to its initial state.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             */
+            template<class OutputIterator>
+            OutputIterator finish(OutputIterator result)
+            {
+                std::size_t n = size_;
+                reset();
+                return encoder_(buf_, buf_ + n, result);
+            }
+
+            /**
+             * Encodes octets from @a in into at most @a out_size
+             * characters at @a out, stopping when either is
+             * exhausted.  Whole quanta are encoded directly into the
+             * output range.  If @a final is @c true, @a in holds the
+             * last octets of the input, and the encoder finishes once
+             * they have been consumed.
+             *
+             * @tparam T a byte type
+             *
+             * @return the status of the encoder and the number of
+             * octets consumed and characters written
+             */
+            template<class T>
+            codec_result process(
+                const T* in, std::size_t in_size,
+                charT* out, std::size_t out_size,
+                bool final
+                )
+            {
+                const T* first = in;
+                const T* last = in + in_size;
+                charT* result = out;
+                charT* out_end = out + out_size;
+                codec_status status;
+
+                for (;;) {
+                    for (; pos_ != end_ && result != out_end; ++pos_, ++result) {
+                        *result = pending_[pos_];
+                    }
+                    if (pos_ != end_) {
+                        status = codec_output_full;
+                        break;
+                    }
+
+                    if (first == last) {
+                        if (!final) {
+                            status = codec_need_input;
+                        } else if (!finished_) {
+                            end_ = encoder_(buf_, buf_ + size_, pending_) - pending_;
+                            pos_ = 0;
+                            size_ = 0;
+                            finished_ = true;
+                            continue;
+                        } else {
+                            reset();
+                            status = codec_done;
+                        }
+                        break;
+                    }
+
+                    if (result == out_end) {
+                        status = codec_output_full;
+                        break;
+                    }
+
+                    if (size_ == 0) {
+                        std::size_t n = std::size_t(last - first) / Octets;
+                        std::size_t m = std::size_t(out_end - result) / Chars;
+                        if (n > m) {
+                            n = m;
+                        }
+                        if (n != 0) {
+                            result = encoder_(first, first + n * Octets, result);
+                            first += n * Octets;
+                            continue;
+                        }
+                    }
+
+                    if (Octets == 1) {
+                        end_ = encoder_(first, first + 1, pending_) - pending_;
+                        pos_ = 0;
+                        ++first;
+                        continue;
+                    }
+
+                    buf_[size_++] = *first;
+                    ++first;
+
+                    if (size_ == Octets) {
+                        end_ = encoder_(buf_, buf_ + Octets, pending_) - pending_;
+                        pos_ = 0;
+                        size_ = 0;
+                    }
+                }
+
+                return make_codec_result(status, first - in, result - out);
+            }
+
+            /**
+             * Discards any octets and characters held back by the
+             * encoder.
+             */
+            void reset() {
+                size_ = 0;
+                pos_ = end_ = 0;
+                finished_ = false;
+            }
+
+        private:
+            template<class InputIterator, class OutputIterator>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                std::input_iterator_tag
+                )
+            {
+                if (Octets == 1) {
+                    return encoder_(first, last, result);
+                }
+
+                for (; first != last; ++first) {
+                    buf_[size_++] = *first;
+                    if (size_ == Octets) {
+                        result = encoder_(buf_, buf_ + Octets, result);
+                        size_ = 0;
+                    }
+                }
+                return result;
+            }
+
+            template<class InputIterator, class OutputIterator>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                std::random_access_iterator_tag
+                )
+            {
+                if (Octets != 1 && size_ != 0) {
+                    for (; size_ != Octets; ++first, ++size_) {
+                        if (first == last) {
+                            return result;
+                        }
+                        buf_[size_] = *first;
+                    }
+                    result = encoder_(buf_, buf_ + Octets, result);
+                    size_ = 0;
+                }
+
+                InputIterator mid = first + (last - first) / Octets * Octets;
+                result = encoder_(first, mid, result);
+
+                for (; mid != last; ++mid) {
+                    buf_[size_++] = *mid;
+                }
+                return result;
+            }
+
+            Encoder encoder_;
+            unsigned char buf_[Octets];
+            std::size_t size_;
+            charT pending_[Chars];
+            std::size_t pos_;
+            std::size_t end_;
+            bool finished_;
+        };
+
+        /*
+         * Decodes a sequence of character ranges as if they were one,
+         * accumulating the values of up to Chars - 1 characters that
+         * do not complete a quantum until the next call to update()
+         * or finish().  At the start of every quantum, contiguous
+         * chunks are passed to the codec's fast path in place, and
+         * only characters it leaves alone are decoded one at a time.
+         * process() also holds back the decoded octets of one
+         * quantum that do not fit into the output range.
+         *
+         * Padded tells whether traits_type::pad() ends the encoded
+         * data; Codec must befriend this class.
+         */
+        template<class Codec, int Bits, int Chars, bool Padded>
+        class chunk_decoder {
+        public:
+            typedef typename Codec::char_type char_type;
+
+            typedef typename Codec::traits_type traits_type;
+
+            typedef typename Codec::int_type int_type;
+
+            explicit chunk_decoder(const char* what)
+            : what_(what), value_(0), size_(0), padded_(false),
+              pos_(0), end_(0), finished_(false) { }
+
+            /**
+             * Decodes a range of characters, continuing any quantum
+             * left incomplete by a previous call.  Characters
+             * following a padding character are ignored.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             *
+             * @throw invalid_character if a character not in the
+             * encoding alphabet is encountered
+             */
+            template<class InputIterator, class OutputIterator>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result
+                )
+            {
+                return update(first, last, result, noskip());
+            }
+
+            /**
+             * Decodes a range of characters, continuing any quantum
+             * left incomplete by a previous call.  Characters not in
+             * the encoding alphabet for which @a skip evaluates to @c
+             * true are ignored, as are all characters following a
+             * padding character.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             *
+             * @throw invalid_character if a character not in the
+             * encoding alphabet is encountered
+             */
+            template<class InputIterator, class OutputIterator, class Predicate>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                Predicate skip
+                )
+            {
+                typedef typename range_category<
+                    InputIterator, OutputIterator, char_type
+                    >::type tag;
+                return update(first, last, result, skip, tag());
+            }
+
+            /**
+             * Decodes a range of characters as update() above,
+             * splitting the whole quanta that follow any quantum left
+             * incomplete by a previous call into chunks that are
+             * decoded concurrently as requested by @a policy.  The
+             * alphabet characters are counted first, so that the
+             * characters of an incomplete last quantum can be held
+             * back.  Both @a first and @a result must be random
+             * access iterators.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             *
+             * @throw invalid_character if a character not in the
+             * encoding alphabet is encountered
+             */
+            template<class RandomAccessIterator, class OutputIterator>
+            OutputIterator update(
+                const parallel_policy& policy,
+                RandomAccessIterator first, RandomAccessIterator last,
+                OutputIterator result
+                )
+            {
+                return update(policy, first, last, result, skip_none());
+            }
+
+            /**
+             * Decodes a range of characters as update() above,
+             * splitting it into chunks that are decoded concurrently
+             * as requested by @a policy.  Characters not in the
+             * encoding alphabet for which @a skip evaluates to @c
+             * true are ignored.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             *
+             * @throw invalid_character if a character not in the
+             * encoding alphabet is encountered
+             */
+            template<class RandomAccessIterator, class OutputIterator, class Predicate>
+            OutputIterator update(
+                const parallel_policy& policy,
+                RandomAccessIterator first, RandomAccessIterator last,
+                OutputIterator result, Predicate skip
+                )
+            {
+                typedef validator<Codec, Bits, Chars, Padded> scanner;
+
+                for (; size_ != 0 && !padded_ && first != last; ++first) {
+                    if (!step(*first, result, skip)) {
+                        STLENCODERS_THROW(invalid_character(what_));
+                    }
+                }
+
+                if (!padded_ && policy.threads(last - first) != 1) {
+                    RandomAccessIterator mid = last;
+                    result = decode_result_value(
+                        parallel_decode<Codec, scanner>(policy, first, mid, result, skip, Chars, octets, false),
+                        what_
+                        );
+                    first = mid;
+                }
+                return update(first, last, result, skip);
+            }
+
+            /**
+             * Decodes the characters of an incomplete quantum held by
+             * the decoder, and resets the decoder to its initial
+             * state.
+             *
+             * @return an output iterator referring to one past the
+             * last value assigned to the output range
+             *
+             * @throw invalid_length if the characters passed to
+             * update() contain an invalid number of encoding
+             * characters
+             */
+            template<class OutputIterator>
+            OutputIterator finish(OutputIterator result)
+            {
+                const int n = size_;
+                const unsigned long long v = value_;
+                reset();
+
+                if (!valid_length(n)) {
+                    STLENCODERS_THROW(invalid_length(what_));
+                }
+                return put(v >> n * Bits % 8, n * Bits / 8, result);
+            }
+
+            /**
+             * Decodes characters from @a in into at most @a out_size
+             * octets at @a out, stopping when either is exhausted.
+             * Whole quanta are decoded directly into the output
+             * range.  If @a final is @c true, @a in holds the last
+             * characters of the input, and the decoder finishes once
+             * they have been consumed.
+             *
+             * @tparam T a byte type
+             *
+             * @return the status of the decoder and the number of
+             * characters consumed and octets written
+             */
+            template<class T>
+            codec_result process(
+                const char_type* in, std::size_t in_size,
+                T* out, std::size_t out_size,
+                bool final
+                )
+            {
+                noskip skip;
+                return process(in, in_size, out, out_size, final, skip);
+            }
+
+            /**
+             * Decodes characters from @a in into at most @a out_size
+             * octets at @a out, as process() above, ignoring
+             * characters not in the encoding alphabet for which @a
+             * skip evaluates to @c true.
+             */
+            template<class T, class Predicate>
+            codec_result process(
+                const char_type* in, std::size_t in_size,
+                T* out, std::size_t out_size,
+                bool final, Predicate skip
+                )
+            {
+                typedef typename range_category<
+                    const char_type*, T*, char_type
+                    >::type tag;
+                return process(in, in_size, out, out_size, final, skip, tag());
+            }
+
+            /**
+             * Discards the characters and octets held back by the
+             * decoder, and any padding seen.
+             */
+            void reset() {
+                value_ = 0;
+                size_ = 0;
+                padded_ = false;
+                pos_ = end_ = 0;
+                finished_ = false;
+            }
+
+        private:
+            struct noskip { };
+
+            enum { octets = Bits * Chars / 8 };
+
+            template<class InputIterator, class OutputIterator, class Predicate, class IteratorTag>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                Predicate& skip, IteratorTag
+                )
+            {
+                return update(first, last, result, skip, false_type());
+            }
+
+            template<class InputIterator, class OutputIterator, class Predicate>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                Predicate& skip, contiguous_iterator_tag
+                )
+            {
+                const char_type* src = address<const char_type>(first);
+                unsigned char* dst = address<unsigned char>(result);
+                return result + (update(src, src + (last - first), dst, skip, true_type()) - dst);
+            }
+
+            template<class InputIterator, class OutputIterator, class Predicate, bool Contiguous>
+            OutputIterator update(
+                InputIterator first, InputIterator last, OutputIterator result,
+                Predicate& skip, bool_constant<Contiguous> contiguous
+                )
+            {
+                while (!padded_) {
+                    if (size_ == 0) {
+                        Codec::decode_fast(first, last, result, contiguous);
+                    }
+                    if (first == last) {
+                        break;
+                    }
+                    if (!step(*first, result, skip)) {
+                        STLENCODERS_THROW(invalid_character(what_));
+                    }
+                    ++first;
+                }
+                return result;
+            }
+
+            template<class T, class Predicate, class IteratorTag>
+            codec_result process(
+                const char_type* in, std::size_t in_size,
+                T* out, std::size_t out_size,
+                bool final, Predicate& skip, IteratorTag
+                )
+            {
+                return run(in, in_size, out, out_size, final, skip, false_type());
+            }
+
+            template<class T, class Predicate>
+            codec_result process(
+                const char_type* in, std::size_t in_size,
+                T* out, std::size_t out_size,
+                bool final, Predicate& skip, contiguous_iterator_tag
+                )
+            {
+                return run(in, in_size, address<unsigned char>(out), out_size, final, skip, true_type());
+            }
+
+            template<class OutputIterator, class Predicate, bool Contiguous>
+            codec_result run(
+                const char_type* in, std::size_t in_size,
+                OutputIterator out, std::size_t out_size,
+                bool final, Predicate& skip, bool_constant<Contiguous> contiguous
+                )
+            {
+                const char_type* first = in;
+                const char_type* last = in + in_size;
+                OutputIterator result = out;
+                OutputIterator out_end = out + out_size;
+                codec_status status;
+
+                for (;;) {
+                    for (; pos_ != end_ && result != out_end; ++pos_, ++result) {
+                        *result = pending_[pos_];
+                    }
+                    if (pos_ != end_) {
+                        status = codec_output_full;
+                        break;
+                    }
+
+                    if (padded_) {
+                        first = last;
+                    }
+
+                    if (first == last) {
+                        if (!final) {
+                            status = codec_need_input;
+                        } else if (finished_) {
+                            reset();
+                            status = codec_done;
+                        } else if (!valid_length(size_)) {
+                            reset();
+                            status = codec_error;
+                        } else {
+                            end_ = put(value_ >> size_ * Bits % 8, size_ * Bits / 8, pending_) - pending_;
+                            pos_ = 0;
+                            finished_ = true;
+                            continue;
+                        }
+                        break;
+                    }
+
+                    if (size_ == 0) {
+                        std::size_t n = last - first;
+                        std::size_t m = std::size_t(out_end - result) / octets * Chars;
+                        const char_type* p = first;
+                        Codec::decode_fast(first, n < m ? last : first + m, result, contiguous);
+                        if (first != p) {
+                            continue;
+                        }
+                    }
+
+                    unsigned char* p = pending_;
+                    if (!step(*first, p, skip)) {
+                        reset();
+                        status = codec_error;
+                        break;
+                    }
+                    ++first;
+                    end_ = p - pending_;
+                    pos_ = 0;
+                }
+
+                return make_codec_result(status, first - in, result - out);
+            }
+
+            /*
+             * Decodes a single character, writing a completed
+             * quantum to result.  Returns false if c is invalid.
+             */
+            template<class OutputIterator, class Predicate>
+            bool step(char_type c, OutputIterator& result, Predicate& skip)
+            {
+                int_type v = traits_type::to_int_type(c);
+                if (!traits_type::eq_int_type(v, traits_type::inv())) {
+                    value_ = value_ << Bits | v;
+                    if (++size_ == Chars) {
+                        result = put(value_, octets, result);
+                        value_ = 0;
+                        size_ = 0;
+                    }
+                } else if (skipped(skip, c)) {
+                    // ignore
+                } else if (padding(c, bool_constant<Padded>())) {
+                    padded_ = true;
+                } else {
+                    return false;
+                }
+                return true;
+            }
+
+            // a trailing character contributing no whole octet
+            static bool valid_length(int n) {
+                return n == 0 || n * Bits / 8 != (n - 1) * Bits / 8;
+            }
+
+            template<class OutputIterator>
+            static OutputIterator put(unsigned long long v, int n, OutputIterator result)
+            {
+                while (n-- != 0) {
+                    *result = static_cast<unsigned char>(v >> n * 8);
+                    ++result;
+                }
+                return result;
+            }
+
+            template<class Predicate>
+            static bool skipped(Predicate& skip, char_type c) {
+                return skip(c);
+            }
+
+            static bool skipped(noskip&, char_type) {
+                return false;
+            }
+
+            static bool padding(char_type c, true_type) {
+                return traits_type::eq(c, traits_type::pad());
+            }
+
+            static bool padding(char_type, false_type) {
+                return false;
+            }
+
+            const char* what_;
+            unsigned long long value_;
+            int size_;
+            bool padded_;
+            unsigned char pending_[octets];
+            int pos_;
+            int end_;
+            bool finished_;
+        };
+    }
+}
+
+#endif
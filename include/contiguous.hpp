@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef STLENCODERS_CONTIGUOUS_HPP
+#define STLENCODERS_CONTIGUOUS_HPP
+
+#include <climits>
+#include <iterator>
+
+#if defined(__has_include)
+# if __has_include(<version>)
+#  include <version>
+# endif
+#endif
+
+#if defined(__cpp_lib_concepts) && defined(__cpp_lib_to_address)
+# define STLENCODERS_CONTIGUOUS_ITERATOR 1
+# include <memory>
+# include <type_traits>
+#endif
+
+/**
+ * @file
+ *
+ * Detection of contiguous iterator ranges.
+ *
+ * Encoding and decoding functions use this to route ranges of
+ * narrow characters and octets that are stored contiguously in
+ * memory to pointer-based implementations.  Besides plain pointers,
+ * contiguous iterators are recognized as such if the standard
+ * library provides the @c std::contiguous_iterator concept, or if
+ * they are @c std::vector or @c std::basic_string iterators of a
+ * known standard library implementation.
+ */
+
+namespace stlencoders {
+    namespace detail {
+        template<bool B> struct bool_constant { enum { value = B }; };
+
+        typedef bool_constant<true> true_type;
+        typedef bool_constant<false> false_type;
+
+        template<bool B, class T, class F> struct conditional {
+            typedef T type;
+        };
+
+        template<class T, class F> struct conditional<false, T, F> {
+            typedef F type;
+        };
+
+        template<class T> struct is_byte : false_type { };
+
+#if UCHAR_MAX == 255
+        template<> struct is_byte<char> : true_type { };
+        template<> struct is_byte<signed char> : true_type { };
+        template<> struct is_byte<unsigned char> : true_type { };
+#endif
+
+        template<class T> struct remove_const { typedef T type; };
+        template<class T> struct remove_const<const T> { typedef T type; };
+
+        /*
+         * Contiguous iterator traits: value is true if Iterator
+         * refers to elements of type element_type stored contiguously
+         * in memory, and address() converts an iterator, which need
+         * not be dereferenceable, to a pointer.
+         */
+        template<class Iterator, class Enable = void>
+        struct contiguous_iterator : false_type { };
+
+        template<class T>
+        struct contiguous_iterator<T*> : true_type {
+            typedef T element_type;
+
+            static T* address(T* p) {
+                return p;
+            }
+        };
+
+#if defined(STLENCODERS_CONTIGUOUS_ITERATOR)
+        template<class Iterator>
+        struct contiguous_iterator<
+            Iterator,
+            typename std::enable_if<
+                std::contiguous_iterator<Iterator> && !std::is_pointer<Iterator>::value
+                >::type
+            > : true_type {
+            typedef typename std::remove_reference<
+                std::iter_reference_t<Iterator>
+                >::type element_type;
+
+            static element_type* address(const Iterator& i) {
+                return std::to_address(i);
+            }
+        };
+#elif defined(__GLIBCXX__)
+        template<class T, class Container>
+        struct contiguous_iterator<__gnu_cxx::__normal_iterator<T*, Container> >
+        : true_type {
+            typedef T element_type;
+
+            static T* address(const __gnu_cxx::__normal_iterator<T*, Container>& i) {
+                return i.base();
+            }
+        };
+#elif defined(_LIBCPP_VERSION)
+        template<class T>
+        struct contiguous_iterator<std::__wrap_iter<T*> > : true_type {
+            typedef T element_type;
+
+            static T* address(const std::__wrap_iter<T*>& i) {
+                return i.base();
+            }
+        };
+#endif
+
+        template<class Iterator, bool = contiguous_iterator<Iterator>::value>
+        struct is_contiguous_bytes : false_type { };
+
+        template<class Iterator>
+        struct is_contiguous_bytes<Iterator, true>
+        : bool_constant<is_byte<
+            typename remove_const<
+                typename contiguous_iterator<Iterator>::element_type
+                >::type
+            >::value> { };
+
+        template<class Iterator, bool = contiguous_iterator<Iterator>::value>
+        struct is_contiguous_mutable_bytes : false_type { };
+
+        template<class Iterator>
+        struct is_contiguous_mutable_bytes<Iterator, true>
+        : is_byte<typename contiguous_iterator<Iterator>::element_type> { };
+
+        /*
+         * Iterator tag for ranges of narrow characters or octets
+         * where both input and output are stored contiguously.
+         */
+        struct contiguous_iterator_tag { };
+
+        /*
+         * Selects contiguous_iterator_tag if an input range of
+         * InputIterator can be transformed into an output range of
+         * OutputIterator using pointers to byte-sized elements, or
+         * the input iterator category otherwise.
+         */
+        template<class InputIterator, class OutputIterator, class charT>
+        struct range_category {
+            typedef typename conditional<
+                is_byte<charT>::value &&
+                is_contiguous_bytes<InputIterator>::value &&
+                is_contiguous_mutable_bytes<OutputIterator>::value,
+                contiguous_iterator_tag,
+                typename std::iterator_traits<InputIterator>::iterator_category
+                >::type type;
+        };
+
+        template<class T, class Iterator>
+        inline T* address(const Iterator& i)
+        {
+            return reinterpret_cast<T*>(contiguous_iterator<Iterator>::address(i));
+        }
+    }
+}
+
+#endif
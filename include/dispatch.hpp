@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_DISPATCH_HPP
+#define STLENCODERS_DISPATCH_HPP
+
+#include "simd.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(STLENCODERS_NO_THREADS)
+# if __cplusplus >= 201103L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201103L)
+#  define STLENCODERS_THREADS 1
+# endif
+#endif
+
+#if defined(STLENCODERS_THREADS)
+# include <atomic>
+# include <mutex>
+#endif
+
+#if defined(STLENCODERS_RUNTIME_DISPATCH)
+# if defined(_MSC_VER)
+#  include <intrin.h>
+# else
+#  include <cpuid.h>
+# endif
+#endif
+
+/**
+ * @file
+ *
+ * Runtime selection of vectorized block kernels.
+ *
+ * The instruction set extensions supported by the executing
+ * processor are probed once per process, and the block kernels of
+ * each encoding scheme are resolved on first use and cached as
+ * function pointers.  The environment variable @c STLENCODERS_SIMD
+ * may be set to @c scalar, @c ssse3, @c avx2 or @c avx512 to limit
+ * the kernels being used, which is also possible programmatically
+ * using set_simd_level().  Other values of @c STLENCODERS_SIMD are
+ * silently ignored.  When compiling as C++11 or later, kernels may
+ * be resolved concurrently by multiple threads.
+ */
+namespace stlencoders {
+    /**
+     * Instruction set extension levels for which block kernels may
+     * be available.
+     */
+    enum simd_level {
+        /**
+         * Use portable scalar code only.
+         */
+        simd_scalar,
+
+        /**
+         * Use SSSE3 block kernels.
+         */
+        simd_ssse3,
+
+        /**
+         * Use AVX2 block kernels.
+         */
+        simd_avx2,
+
+        /**
+         * Use AVX-512 block kernels, which require the AVX-512 BW,
+         * VBMI and VBMI2 extensions.
+         */
+        simd_avx512
+    };
+
+    namespace detail {
+        struct dispatch_node {
+            void (*reset)();
+            dispatch_node* next;
+        };
+
+        inline dispatch_node*& dispatch_list()
+        {
+            static dispatch_node* head = 0;
+            return head;
+        }
+
+#if defined(STLENCODERS_THREADS)
+        inline std::mutex& dispatch_mutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+#endif
+
+        inline int& dispatch_level()
+        {
+            static int level = -1;
+            return level;
+        }
+
+#if defined(STLENCODERS_RUNTIME_DISPATCH)
+        inline void cpuid(unsigned leaf, unsigned subleaf, unsigned* regs)
+        {
+# if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, leaf, subleaf);
+            for (int i = 0; i != 4; ++i) {
+                regs[i] = r[i];
+            }
+# else
+            __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+# endif
+        }
+
+        inline unsigned long long xgetbv()
+        {
+# if defined(_MSC_VER)
+            return _xgetbv(0);
+# else
+            unsigned eax, edx;
+            __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return static_cast<unsigned long long>(edx) << 32 | eax;
+# endif
+        }
+
+        inline simd_level cpu_simd_level()
+        {
+            unsigned regs[4];
+
+            cpuid(0, 0, regs);
+            unsigned max = regs[0];
+
+            cpuid(1, 0, regs);
+            if (!(regs[2] & 1u << 9)) {
+                return simd_scalar;
+            }
+
+            // AVX state must be enabled by the operating system
+            const unsigned osxsave_avx = 1u << 27 | 1u << 28;
+            if ((regs[2] & osxsave_avx) != osxsave_avx || max < 7) {
+                return simd_ssse3;
+            }
+            unsigned long long xcr0 = xgetbv();
+            if ((xcr0 & 0x06) != 0x06) {
+                return simd_ssse3;
+            }
+
+            cpuid(7, 0, regs);
+            if (!(regs[1] & 1u << 5)) {
+                return simd_ssse3;
+            }
+
+            const unsigned avx512fbw = 1u << 16 | 1u << 30;
+            const unsigned avx512vbmi = 1u << 1 | 1u << 6;
+            if ((regs[1] & avx512fbw) != avx512fbw || (regs[2] & avx512vbmi) != avx512vbmi) {
+                return simd_avx2;
+            }
+            if ((xcr0 & 0xe6) != 0xe6) {
+                return simd_avx2;
+            }
+            return simd_avx512;
+        }
+#else
+        inline simd_level cpu_simd_level()
+        {
+# if defined(STLENCODERS_AVX512)
+            return simd_avx512;
+# elif defined(STLENCODERS_AVX2)
+            return simd_avx2;
+# elif defined(STLENCODERS_SSSE3)
+            return simd_ssse3;
+# else
+            return simd_scalar;
+# endif
+        }
+#endif
+
+        /*
+         * Limits level as requested by the STLENCODERS_SIMD
+         * environment variable.  Unknown values, including
+         * misspelled ones, are ignored just like "avx512", which
+         * imposes no limit.
+         */
+        inline simd_level env_simd_level(simd_level level)
+        {
+            const char* s = std::getenv("STLENCODERS_SIMD");
+
+            if (!s) {
+                return level;
+            } else if (std::strcmp(s, "scalar") == 0) {
+                return simd_scalar;
+            } else if (std::strcmp(s, "ssse3") == 0) {
+                return level < simd_ssse3 ? level : simd_ssse3;
+            } else if (std::strcmp(s, "avx2") == 0) {
+                return level < simd_avx2 ? level : simd_avx2;
+            } else {
+                return level;
+            }
+        }
+
+        /*
+         * Caches the function pointer selected by Kernel::select()
+         * for the current SIMD level.  Kernel::function_type shall
+         * be a function pointer type.
+         */
+        template<class Kernel>
+        struct dispatch {
+            typedef typename Kernel::function_type function_type;
+
+            static function_type get() {
+                function_type f = ptr;
+                return f ? f : resolve();
+            }
+
+        private:
+#if defined(STLENCODERS_THREADS)
+            typedef std::atomic<function_type> pointer_type;
+#else
+            typedef function_type pointer_type;
+#endif
+
+            static function_type resolve();
+
+            static void reset() {
+                ptr = 0;
+            }
+
+            static pointer_type ptr;
+            static dispatch_node node;
+        };
+
+        template<class Kernel>
+        typename dispatch<Kernel>::pointer_type dispatch<Kernel>::ptr(0);
+
+        template<class Kernel>
+        dispatch_node dispatch<Kernel>::node = { 0, 0 };
+    }
+
+    /**
+     * Returns the highest SIMD level supported by both the executing
+     * processor and the compiled block kernels.
+     */
+    inline simd_level detect_simd_level()
+    {
+        static const simd_level level = detail::cpu_simd_level();
+        return level;
+    }
+
+    /**
+     * Returns the SIMD level block kernels are currently selected
+     * for.
+     *
+     * Unless set_simd_level() has been called, this is the result of
+     * detect_simd_level(), limited by the @c STLENCODERS_SIMD
+     * environment variable.
+     */
+    inline simd_level get_simd_level()
+    {
+        int& level = detail::dispatch_level();
+
+        if (level < 0) {
+            level = detail::env_simd_level(detect_simd_level());
+        }
+        return static_cast<simd_level>(level);
+    }
+
+    /**
+     * Selects block kernels for a given SIMD level.
+     *
+     * This function is intended for testing and benchmarking, and
+     * shall not be called while other threads are using any of the
+     * encoding schemes.
+     *
+     * @param level the requested SIMD level
+     *
+     * @return the selected SIMD level, which is the lesser of @a
+     * level and detect_simd_level()
+     */
+    inline simd_level set_simd_level(simd_level level)
+    {
+        if (level > detect_simd_level()) {
+            level = detect_simd_level();
+        }
+#if defined(STLENCODERS_THREADS)
+        std::lock_guard<std::mutex> lock(detail::dispatch_mutex());
+#endif
+        detail::dispatch_level() = level;
+
+        for (detail::dispatch_node* p = detail::dispatch_list(); p; p = p->next) {
+            p->reset();
+        }
+        return level;
+    }
+
+    namespace detail {
+        template<class Kernel>
+        typename dispatch<Kernel>::function_type dispatch<Kernel>::resolve()
+        {
+#if defined(STLENCODERS_THREADS)
+            std::lock_guard<std::mutex> lock(dispatch_mutex());
+#endif
+            if (!node.reset) {
+                node.reset = &reset;
+                node.next = dispatch_list();
+                dispatch_list() = &node;
+            }
+            return ptr = Kernel::select(get_simd_level());
+        }
+    }
+}
+
+#endif
@@ -25,12 +25,27 @@
 #ifndef STLENCODERS_ERROR_HPP
 #define STLENCODERS_ERROR_HPP
 
+#include <cstddef>
 #include <stdexcept>
 
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+# define STLENCODERS_EXCEPTIONS 1
+#endif
+
+/*
+ * Throws an exception, or aborts if exceptions are disabled.
+ */
+#if defined(STLENCODERS_EXCEPTIONS)
+# define STLENCODERS_THROW(e) throw e
+#else
+# include <cstdlib>
+# define STLENCODERS_THROW(e) (static_cast<void>(sizeof(e)), std::abort())
+#endif
+
 /**
  * @file
  *
- * Exception classes used to report decoding errors.
+ * Exception classes and status codes used to report decoding errors.
  */
 namespace stlencoders {
     /**
@@ -70,6 +85,101 @@ namespace stlencoders {
         explicit invalid_length(const std::string& s)
         : decode_error(s) { }
     };
+
+    /**
+     * Status codes reported by the non-throwing decoding and
+     * validation functions.
+     */
+    enum decode_status {
+        /**
+         * The character range has been decoded.
+         */
+        decode_ok,
+
+        /**
+         * A character not in the encoding alphabet was encountered.
+         */
+        decode_invalid_character,
+
+        /**
+         * The character range contains an invalid number of encoding
+         * characters.
+         */
+        decode_invalid_length
+    };
+
+    /**
+     * The result of a non-throwing decoding function.
+     *
+     * @tparam OutputIterator the output iterator type
+     */
+    template<class OutputIterator>
+    struct decode_result {
+        /**
+         * The status of the decode operation.
+         */
+        decode_status status;
+
+        /**
+         * An output iterator referring to one past the last value
+         * assigned to the output range.
+         */
+        OutputIterator result;
+
+        /**
+         * The offset of the character at which decoding stopped:
+         * the first invalid character, the padding character, or
+         * the end of the character range.
+         */
+        std::size_t offset;
+    };
+
+    /**
+     * The result of a validation function.
+     */
+    struct validate_result {
+        /**
+         * The status decoding the character range would report.
+         */
+        decode_status status;
+
+        /**
+         * The offset of the character at which validation stopped:
+         * the first invalid character, the padding character, or
+         * the end of the character range.
+         */
+        std::size_t offset;
+    };
+
+    namespace detail {
+        template<class OutputIterator>
+        decode_result<OutputIterator> make_decode_result(
+            decode_status status, OutputIterator result, std::size_t offset
+            )
+        {
+            decode_result<OutputIterator> r = { status, result, offset };
+            return r;
+        }
+
+        /*
+         * Returns r.result, or throws the exception corresponding to
+         * r.status.
+         */
+        template<class OutputIterator>
+        OutputIterator decode_result_value(
+            const decode_result<OutputIterator>& r, const char* what
+            )
+        {
+            switch (r.status) {
+            case decode_invalid_character:
+                STLENCODERS_THROW(invalid_character(what));
+            case decode_invalid_length:
+                STLENCODERS_THROW(invalid_length(what));
+            default:
+                return r.result;
+            }
+        }
+    }
 }
 
 #endif
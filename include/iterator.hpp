@@ -26,6 +26,7 @@
 #define STLENCODERS_ITERATOR_HPP
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <string>
 
@@ -46,10 +47,18 @@ namespace stlencoders {
      * @tparam traits the output character traits type
     */
     template<class Iterator, class charT, class traits = std::char_traits<charT> >
-    class line_wrap_iterator
-    : public std::iterator<std::output_iterator_tag, void, void, void, void>
-    {
+    class line_wrap_iterator {
     public:
+        /**
+         * The iterator category and associated types of an output
+         * iterator.
+         */
+        typedef std::output_iterator_tag iterator_category;
+        typedef void value_type;
+        typedef void difference_type;
+        typedef void pointer;
+        typedef void reference;
+
         /**
          * The underlying iterator type.
          */
@@ -176,6 +185,51 @@ namespace stlencoders {
     {
         return line_wrap_iterator<Iterator, charT>(i, n, s);
     }
+
+    namespace detail {
+        /*
+         * An input iterator adaptor that counts how often it has
+         * been incremented, so that single-pass ranges can report
+         * the offset at which processing stopped.
+         */
+        template<class Iterator>
+        class counting_iterator {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef typename std::iterator_traits<Iterator>::value_type value_type;
+            typedef typename std::iterator_traits<Iterator>::difference_type difference_type;
+            typedef typename std::iterator_traits<Iterator>::pointer pointer;
+            typedef value_type reference;
+
+            explicit counting_iterator(Iterator i) : base_(i), count_(0) { }
+
+            value_type operator*() const {
+                return *base_;
+            }
+
+            counting_iterator& operator++() {
+                ++base_;
+                ++count_;
+                return *this;
+            }
+
+            bool operator==(const counting_iterator& rhs) const {
+                return base_ == rhs.base_;
+            }
+
+            bool operator!=(const counting_iterator& rhs) const {
+                return base_ != rhs.base_;
+            }
+
+            std::size_t count() const {
+                return count_;
+            }
+
+        private:
+            Iterator base_;
+            std::size_t count_;
+        };
+    }
 }
 
 #endif
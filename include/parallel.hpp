@@ -0,0 +1,516 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef STLENCODERS_PARALLEL_HPP
+#define STLENCODERS_PARALLEL_HPP
+
+#include "dispatch.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#if defined(STLENCODERS_THREADS)
+# include <exception>
+# include <thread>
+#endif
+
+/**
+ * @file
+ *
+ * Parallel execution of encoding and decoding functions.
+ *
+ * Threads are created using @c std::thread when compiling as C++11
+ * or later, unless @c STLENCODERS_NO_THREADS is defined.  Otherwise,
+ * functions taking a parallel_policy run sequentially.
+ */
+namespace stlencoders {
+    /**
+     * An execution policy requesting that a random access range be
+     * split into chunks encoded or decoded concurrently.
+     */
+    class parallel_policy {
+    public:
+        /**
+         * Constructs a parallel execution policy.
+         *
+         * @param threads the maximum number of threads to use, or 0
+         * to use the number of hardware threads
+         *
+         * @param grain the minimum number of elements of the input
+         * range to be handled by each thread
+         */
+        explicit parallel_policy(std::size_t threads = 0, std::size_t grain = 1 << 20)
+        : threads_(threads), grain_(grain != 0 ? grain : 1) { }
+
+        /**
+         * Returns the number of threads to use for n input elements.
+         */
+        std::size_t threads(std::size_t n) const {
+            std::size_t k = threads_;
+#if defined(STLENCODERS_THREADS)
+            if (k == 0) {
+                k = std::thread::hardware_concurrency();
+            }
+#else
+            k = 1;
+#endif
+            return std::max<std::size_t>(std::min(k, n / grain_), 1);
+        }
+
+    private:
+        std::size_t threads_;
+        std::size_t grain_;
+    };
+
+    /**
+     * The default parallel execution policy.
+     */
+    const parallel_policy par = parallel_policy();
+
+    namespace detail {
+#if defined(STLENCODERS_THREADS)
+        template<class Task>
+        void run_task(Task* task, std::size_t i, std::exception_ptr* error)
+        {
+# if defined(STLENCODERS_EXCEPTIONS)
+            try {
+                (*task)(i);
+            } catch (...) {
+                *error = std::current_exception();
+            }
+# else
+            static_cast<void>(error);
+            (*task)(i);
+# endif
+        }
+#endif
+
+        /*
+         * Calls task(i) for all i in [0, n), each on its own thread
+         * except for task(0), which runs on the calling thread.  The
+         * first exception thrown by a task, if any, is rethrown once
+         * all threads have finished.
+         */
+        template<class Task>
+        void run_parallel(Task& task, std::size_t n)
+        {
+#if defined(STLENCODERS_THREADS)
+            std::vector<std::exception_ptr> errors(n);
+            std::vector<std::thread> threads;
+            threads.reserve(n);
+
+# if defined(STLENCODERS_EXCEPTIONS)
+            try {
+                for (std::size_t i = 1; i < n; ++i) {
+                    threads.push_back(std::thread(run_task<Task>, &task, i, &errors[i]));
+                }
+            } catch (...) {
+                // run the tasks no thread could be created for here
+                for (std::size_t i = threads.size() + 1; i < n; ++i) {
+                    run_task(&task, i, &errors[i]);
+                }
+            }
+# else
+            for (std::size_t i = 1; i < n; ++i) {
+                threads.push_back(std::thread(run_task<Task>, &task, i, &errors[i]));
+            }
+# endif
+            run_task(&task, 0, &errors[0]);
+
+            for (std::size_t i = 0; i != threads.size(); ++i) {
+                threads[i].join();
+            }
+# if defined(STLENCODERS_EXCEPTIONS)
+            for (std::size_t i = 0; i != n; ++i) {
+                if (errors[i]) {
+                    std::rethrow_exception(errors[i]);
+                }
+            }
+# endif
+#else
+            for (std::size_t i = 0; i != n; ++i) {
+                task(i);
+            }
+#endif
+        }
+
+        /*
+         * Encodes the octet range [first, first + n) in chunks of a
+         * whole number of quanta of octets octets, the chunk
+         * starting at octet k being written to result + k / octets *
+         * chars.  Only the last chunk may produce padding.
+         */
+        template<class Encoder, class RandomAccessIterator, class OutputIterator>
+        class parallel_encoder {
+        public:
+            parallel_encoder(
+                RandomAccessIterator first, std::size_t n, OutputIterator result,
+                Encoder encoder, std::size_t chunk, std::size_t chars, std::size_t octets
+                )
+            : first_(first), n_(n), result_(result), encoder_(encoder),
+              chunk_(chunk), chars_(chars), octets_(octets), last_(result) { }
+
+            void operator()(std::size_t i) {
+                std::size_t a = i * chunk_;
+                std::size_t b = std::min(a + chunk_, n_);
+                OutputIterator r = encoder_(first_ + a, first_ + b, result_ + a / octets_ * chars_);
+                if (b == n_) {
+                    last_ = r;
+                }
+            }
+
+            OutputIterator result() const {
+                return last_;
+            }
+
+        private:
+            RandomAccessIterator first_;
+            std::size_t n_;
+            OutputIterator result_;
+            Encoder encoder_;
+            std::size_t chunk_;
+            std::size_t chars_;
+            std::size_t octets_;
+            OutputIterator last_;
+        };
+
+        /*
+         * Decodes the character range [first, first + n) in chunks
+         * of a whole number of quanta of chars characters, the chunk
+         * starting at character k being written to result + k /
+         * chars * octets, and records the result of each chunk.
+         */
+        template<class Codec, class RandomAccessIterator, class OutputIterator>
+        class parallel_decoder {
+        public:
+            parallel_decoder(
+                RandomAccessIterator first, std::size_t n, OutputIterator result,
+                std::size_t chunk, std::size_t chars, std::size_t octets,
+                std::size_t count
+                )
+            : first_(first), n_(n), result_(result),
+              chunk_(chunk), chars_(chars), octets_(octets),
+              results_(count, make_decode_result(decode_ok, result, 0)) { }
+
+            void operator()(std::size_t i) {
+                std::size_t a = i * chunk_;
+                std::size_t b = std::min(a + chunk_, n_);
+                results_[i] = Codec::try_decode(first_ + a, first_ + b, result_ + a / chars_ * octets_);
+            }
+
+            /*
+             * Combines the chunk results as if the range had been
+             * decoded at once: decoding ends with the first chunk
+             * that stops short of its end.
+             */
+            decode_result<OutputIterator> result() const {
+                std::size_t i = 0;
+                for (; i != results_.size() - 1; ++i) {
+                    if (results_[i].status != decode_ok || results_[i].offset != chunk_) {
+                        break;
+                    }
+                }
+                decode_result<OutputIterator> r = results_[i];
+                r.offset += i * chunk_;
+                return r;
+            }
+
+        private:
+            RandomAccessIterator first_;
+            std::size_t n_;
+            OutputIterator result_;
+            std::size_t chunk_;
+            std::size_t chars_;
+            std::size_t octets_;
+            std::vector<decode_result<OutputIterator> > results_;
+        };
+
+        /*
+         * Counts the characters of each chunk of [first, first + n)
+         * up to the first one neither in the encoding alphabet nor
+         * to be skipped, using Scanner::scan().
+         */
+        template<class Scanner, class RandomAccessIterator, class Predicate>
+        class parallel_counter {
+        public:
+            parallel_counter(
+                RandomAccessIterator first, std::size_t n, std::size_t chunk,
+                const Predicate& skip, std::size_t count
+                )
+            : first_(first), n_(n), chunk_(chunk), skip_(skip),
+              span_(count), skipped_(count) { }
+
+            void operator()(std::size_t i) {
+                Predicate skip = skip_;
+                std::size_t skipped = 0;
+                RandomAccessIterator p = first_ + i * chunk_;
+                span_[i] = Scanner::scan(p, first_ + end(i), skip, skipped);
+                skipped_[i] = skipped;
+            }
+
+            /*
+             * Returns true if decoding ends within chunk i.
+             */
+            bool stops(std::size_t i) const {
+                return span_[i] != end(i) - i * chunk_;
+            }
+
+            /*
+             * Returns the number of alphabet characters in chunk i
+             * before decoding ends.
+             */
+            std::size_t alphabet(std::size_t i) const {
+                return span_[i] - skipped_[i];
+            }
+
+            /*
+             * Returns the index of the character ending chunk i, or
+             * ending decoding within it.
+             */
+            std::size_t stop(std::size_t i) const {
+                return i * chunk_ + span_[i];
+            }
+
+        private:
+            std::size_t end(std::size_t i) const {
+                return std::min((i + 1) * chunk_, n_);
+            }
+
+            RandomAccessIterator first_;
+            std::size_t n_;
+            std::size_t chunk_;
+            Predicate skip_;
+            std::vector<std::size_t> span_;
+            std::vector<std::size_t> skipped_;
+        };
+
+        /*
+         * Decodes the ranges [first + start[i], first + start[i + 1])
+         * of a character range with skipped characters, the last one
+         * ending at first + n.  Each range starts with the first
+         * character of a quantum, the one at index[i] among the
+         * alphabet characters, and is written to result + index[i] /
+         * chars * octets.
+         */
+        template<class Codec, class RandomAccessIterator, class OutputIterator, class Predicate>
+        class parallel_skip_decoder {
+        public:
+            parallel_skip_decoder(
+                RandomAccessIterator first, std::size_t n, OutputIterator result,
+                const Predicate& skip, std::size_t chars, std::size_t octets,
+                const std::vector<std::size_t>& start,
+                const std::vector<std::size_t>& index
+                )
+            : first_(first), n_(n), result_(result), skip_(skip),
+              chars_(chars), octets_(octets), start_(start), index_(index),
+              results_(start.size(), make_decode_result(decode_ok, result, 0)) { }
+
+            void operator()(std::size_t i) {
+                results_[i] = Codec::try_decode(
+                    first_ + start_[i], first_ + end(i),
+                    result_ + index_[i] / chars_ * octets_, skip_
+                    );
+            }
+
+            decode_result<OutputIterator> result() const {
+                std::size_t i = 0;
+                for (; i != results_.size() - 1; ++i) {
+                    if (results_[i].status != decode_ok || results_[i].offset != end(i) - start_[i]) {
+                        break;
+                    }
+                }
+                decode_result<OutputIterator> r = results_[i];
+                r.offset += start_[i];
+                return r;
+            }
+
+        private:
+            std::size_t end(std::size_t i) const {
+                return i + 1 != start_.size() ? start_[i + 1] : n_;
+            }
+
+            RandomAccessIterator first_;
+            std::size_t n_;
+            OutputIterator result_;
+            Predicate skip_;
+            std::size_t chars_;
+            std::size_t octets_;
+            const std::vector<std::size_t>& start_;
+            const std::vector<std::size_t>& index_;
+            std::vector<decode_result<OutputIterator> > results_;
+        };
+
+        /*
+         * Returns the size of the chunks n elements are split into
+         * for k threads, rounded up to a multiple of quantum.
+         */
+        inline std::size_t parallel_chunk(std::size_t n, std::size_t k, std::size_t quantum)
+        {
+            std::size_t chunk = (n + k - 1) / k;
+            return (chunk + quantum - 1) / quantum * quantum;
+        }
+
+        template<class Encoder, class RandomAccessIterator, class OutputIterator>
+        OutputIterator parallel_encode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last, OutputIterator result,
+            Encoder encoder, std::size_t chars, std::size_t octets
+            )
+        {
+            std::size_t n = last - first;
+            std::size_t k = policy.threads(n);
+            if (k == 1) {
+                return encoder(first, last, result);
+            }
+
+            std::size_t chunk = parallel_chunk(n, k, octets);
+            parallel_encoder<Encoder, RandomAccessIterator, OutputIterator> task(
+                first, n, result, encoder, chunk, chars, octets
+                );
+            run_parallel(task, (n + chunk - 1) / chunk);
+            return task.result();
+        }
+
+        template<class Codec, class RandomAccessIterator, class OutputIterator>
+        decode_result<OutputIterator> parallel_decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last, OutputIterator result,
+            std::size_t chars, std::size_t octets
+            )
+        {
+            std::size_t n = last - first;
+            std::size_t k = policy.threads(n);
+            if (k == 1) {
+                return Codec::try_decode(first, last, result);
+            }
+
+            std::size_t chunk = parallel_chunk(n, k, chars);
+            std::size_t count = (n + chunk - 1) / chunk;
+            parallel_decoder<Codec, RandomAccessIterator, OutputIterator> task(
+                first, n, result, chunk, chars, octets, count
+                );
+            run_parallel(task, count);
+            return task.result();
+        }
+
+        /*
+         * Decodes a character range with skipped characters in two
+         * passes.  First, the alphabet characters of each chunk are
+         * counted concurrently, up to the first character that ends
+         * decoding.  The prefix sums of these counts then move each
+         * chunk boundary forward to the start of the next quantum,
+         * and tell where each chunk's output starts.  Finally, the
+         * chunks are decoded concurrently; those following the one
+         * where decoding ends are not decoded at all.
+         *
+         * Unless @a partial is true, the range is first cut short
+         * before the alphabet characters of an incomplete last
+         * quantum and the character ending decoding, if any, and @a
+         * last is set to its new end, so that the characters held
+         * back can be passed on to a sequential decoder.
+         */
+        template<class Codec, class Scanner, class RandomAccessIterator, class OutputIterator, class Predicate>
+        decode_result<OutputIterator> parallel_decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator& last, OutputIterator result,
+            Predicate& skip, std::size_t chars, std::size_t octets, bool partial
+            )
+        {
+            std::size_t n = last - first;
+            std::size_t k = policy.threads(n);
+            if (k == 1 && (partial || n == 0)) {
+                return Codec::try_decode(first, last, result, skip);
+            }
+
+            std::size_t chunk = parallel_chunk(n, k, 1);
+            std::size_t count = (n + chunk - 1) / chunk;
+            parallel_counter<Scanner, RandomAccessIterator, Predicate> counter(
+                first, n, chunk, skip, count
+                );
+            run_parallel(counter, count);
+
+            if (!partial) {
+                std::size_t alphabet = 0;
+                for (std::size_t i = 0; i != count; ++i) {
+                    alphabet += counter.alphabet(i);
+                    if (counter.stops(i)) {
+                        n = counter.stop(i);
+                        break;
+                    }
+                }
+                for (std::size_t m = alphabet % chars; m != 0; ) {
+                    if (Scanner::category(first[--n], skip) == 0) {
+                        --m;
+                    }
+                }
+                last = first + n;
+            }
+
+            std::vector<std::size_t> start(1, 0), index(1, 0);
+            std::size_t alphabet = counter.alphabet(0);
+            for (std::size_t i = 1; i != count && i * chunk < n && !counter.stops(i - 1); ++i) {
+                // pass the characters completing the previous quantum
+                std::size_t pos = i * chunk;
+                std::size_t m = (chars - alphabet % chars) % chars;
+                int c = 2;
+                for (; pos != n; ++pos) {
+                    c = Scanner::category(first[pos], skip);
+                    if (c == 2 || (c == 0 && m-- == 0)) {
+                        break;
+                    }
+                }
+                if (pos == n || c != 0) {
+                    break;
+                }
+                if (pos != start.back()) {
+                    start.push_back(pos);
+                    index.push_back((alphabet + chars - 1) / chars * chars);
+                }
+                alphabet += counter.alphabet(i);
+            }
+
+            parallel_skip_decoder<Codec, RandomAccessIterator, OutputIterator, Predicate> decoder(
+                first, n, result, skip, chars, octets, start, index
+                );
+            run_parallel(decoder, start.size());
+            return decoder.result();
+        }
+
+        template<class Codec, class Scanner, class RandomAccessIterator, class OutputIterator, class Predicate>
+        decode_result<OutputIterator> parallel_decode(
+            const parallel_policy& policy,
+            RandomAccessIterator first, RandomAccessIterator last, OutputIterator result,
+            Predicate& skip, std::size_t chars, std::size_t octets
+            )
+        {
+            return parallel_decode<Codec, Scanner>(
+                policy, first, last, result, skip, chars, octets, true
+                );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_SIMD_HPP
+#define STLENCODERS_SIMD_HPP
+
+/**
+ * @file
+ *
+ * Common support for vectorized block kernels.
+ *
+ * Block kernels are only used for contiguous ranges of narrow
+ * characters and octets.  On x86-64, kernels for all supported
+ * instruction set extensions are compiled using function target
+ * attributes, and selected at runtime as described in dispatch.hpp.
+ * Elsewhere, kernels are enabled according to the instruction set
+ * extensions the compiler targets.  Defining @c STLENCODERS_NO_SIMD
+ * disables block kernels altogether.
+ *
+ * AVX-512 kernels use the zero-masking forms of intrinsics that GCC
+ * otherwise implements with an undefined source operand, since that
+ * operand is reported by -Wuninitialized.
+ */
+
+#if !defined(STLENCODERS_NO_SIMD)
+# if defined(_MSC_VER) && _MSC_VER >= 1911 && defined(_M_X64)
+#  define STLENCODERS_RUNTIME_DISPATCH 1
+# elif defined(__GNUC__) && defined(__x86_64__) && (__GNUC__ >= 5 || defined(__clang__))
+#  define STLENCODERS_RUNTIME_DISPATCH 1
+# endif
+#endif
+
+#if defined(STLENCODERS_RUNTIME_DISPATCH)
+# define STLENCODERS_AVX512 1
+# define STLENCODERS_AVX2 1
+# define STLENCODERS_SSSE3 1
+#elif !defined(STLENCODERS_NO_SIMD)
+# if defined(__AVX512VBMI__) && defined(__AVX512VBMI2__) && defined(__AVX512BW__)
+#  define STLENCODERS_AVX512 1
+# endif
+# if defined(__AVX2__)
+#  define STLENCODERS_AVX2 1
+# endif
+# if defined(__SSSE3__) || defined(__AVX__)
+#  define STLENCODERS_SSSE3 1
+# endif
+#endif
+
+#if defined(STLENCODERS_RUNTIME_DISPATCH) && defined(__GNUC__)
+# define STLENCODERS_TARGET_SSSE3 __attribute__((target("ssse3")))
+# define STLENCODERS_TARGET_AVX2 __attribute__((target("avx2")))
+# define STLENCODERS_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw,avx512vbmi,avx512vbmi2")))
+#else
+# define STLENCODERS_TARGET_SSSE3
+# define STLENCODERS_TARGET_AVX2
+# define STLENCODERS_TARGET_AVX512
+#endif
+
+#if defined(STLENCODERS_SSSE3) || defined(STLENCODERS_AVX2) || defined(STLENCODERS_AVX512)
+# include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+# include <intrin.h>
+#endif
+
+#include <cstddef>
+
+namespace stlencoders {
+    namespace detail {
+        /*
+         * Returns the number of trailing zero bits in a non-zero
+         * 64-bit value.
+         */
+        inline std::size_t ctz64(unsigned long long x)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long n;
+            _BitScanForward64(&n, x);
+            return n;
+#elif defined(__GNUC__)
+            return __builtin_ctzll(x);
+#else
+            std::size_t n = 0;
+            for (; !(x & 1); x >>= 1) {
+                ++n;
+            }
+            return n;
+#endif
+        }
+
+        /*
+         * Returns the number of one bits in a 64-bit value.
+         */
+        inline std::size_t popcount64(unsigned long long x)
+        {
+#if defined(__GNUC__)
+            return __builtin_popcountll(x);
+#else
+            std::size_t n = 0;
+            for (; x; x &= x - 1) {
+                ++n;
+            }
+            return n;
+#endif
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef STLENCODERS_SKIP_HPP
+#define STLENCODERS_SKIP_HPP
+
+#include "contiguous.hpp"
+#include "dispatch.hpp"
+#include "error.hpp"
+#include "simd.hpp"
+
+#include <cstddef>
+
+/**
+ * @file
+ *
+ * Declarative sets of characters to be skipped when decoding.
+ */
+namespace stlencoders {
+    /**
+     * A decoding predicate that skips the narrow characters of a
+     * fixed set.
+     *
+     * Unlike an arbitrary predicate, a skip set is known to the
+     * decoding functions, which remove skipped characters from
+     * contiguous ranges of narrow characters in bulk, so that
+     * interspersed line breaks or other separators do not leave the
+     * vectorized decoding path.  Characters in the encoding alphabet
+     * are never skipped.
+     */
+    class skip_set {
+    public:
+        /**
+         * Constructs an empty skip set.
+         */
+        skip_set() {
+            for (std::size_t i = 0; i != sizeof bits; ++i) {
+                bits[i] = 0;
+            }
+        }
+
+        /**
+         * Constructs a skip set containing the characters of the
+         * null-terminated string @a s.
+         */
+        explicit skip_set(const char* s) {
+            for (std::size_t i = 0; i != sizeof bits; ++i) {
+                bits[i] = 0;
+            }
+            for (; *s; ++s) {
+                insert(*s);
+            }
+        }
+
+        /**
+         * Adds the character @a c to the skip set.
+         */
+        skip_set& insert(char c) {
+            unsigned char u = static_cast<unsigned char>(c);
+            bits[u >> 3] |= static_cast<unsigned char>(1 << (u & 7));
+            return *this;
+        }
+
+        /**
+         * Returns whether the character @a c is in the skip set.
+         */
+        bool operator()(char c) const {
+            unsigned char u = static_cast<unsigned char>(c);
+            return bits[u >> 3] >> (u & 7) & 1;
+        }
+
+        /**
+         * Returns whether the character @a c, converted to @c char,
+         * is in the skip set.  Characters outside the range of
+         * unsigned char are never in a skip set.
+         */
+        template<class charT>
+        bool operator()(const charT& c) const {
+            return static_cast<unsigned long>(c) <= 0xff && (*this)(static_cast<char>(c));
+        }
+
+        /**
+         * Returns the skip set as a bitmap of 256 bits, with bit @c
+         * c%8 of byte @c c/8 set for each character @c c, converted
+         * to unsigned char, in the set.
+         */
+        const unsigned char* data() const {
+            return bits;
+        }
+
+    private:
+        unsigned char bits[32];
+    };
+
+    /**
+     * A skip set containing the ASCII whitespace characters space,
+     * horizontal tab, line feed, vertical tab, form feed and
+     * carriage return.
+     */
+    class ascii_whitespace : public skip_set {
+    public:
+        ascii_whitespace() : skip_set(" \t\n\v\f\r") { }
+    };
+
+    namespace detail {
+        template<class T>
+        struct is_skip_set {
+            static char test(const skip_set*);
+            static long test(...);
+
+            enum { value = sizeof(test(static_cast<T*>(0))) == 1 };
+        };
+
+        /*
+         * Bitmap of the narrow characters in the encoding alphabet,
+         * built from the encoding traits on first use.
+         */
+        template<class traits>
+        struct alphabet_bitmap {
+            unsigned char value[32];
+
+            alphabet_bitmap() {
+                for (int i = 0; i != 32; ++i) {
+                    value[i] = 0;
+                }
+                for (int i = 0; i != 256; ++i) {
+                    typename traits::char_type c = static_cast<char>(i);
+                    if (!traits::eq_int_type(traits::to_int_type(c), traits::inv())) {
+                        value[i >> 3] |= static_cast<unsigned char>(1 << (i & 7));
+                    }
+                }
+            }
+
+            static const alphabet_bitmap& instance() {
+                static const alphabet_bitmap bitmap;
+                return bitmap;
+            }
+        };
+
+        /*
+         * The characters to be removed from the input, as a bitmap
+         * and as tables for a vectorized lookup: bit h of lo[l] and
+         * hi[l] is set if the character with low nibble l and high
+         * nibble h or h + 8, respectively, is to be removed.
+         */
+        struct skip_tables {
+            unsigned char bitmap[32];
+            unsigned char lo[16];
+            unsigned char hi[16];
+
+            skip_tables(const unsigned char* skip, const unsigned char* alphabet) {
+                for (int i = 0; i != 32; ++i) {
+                    bitmap[i] = skip[i] & ~alphabet[i];
+                }
+                for (int l = 0; l != 16; ++l) {
+                    lo[l] = hi[l] = 0;
+                    for (int h = 0; h != 8; ++h) {
+                        lo[l] |= static_cast<unsigned char>((bitmap[h << 1 | l >> 3] >> (l & 7) & 1) << h);
+                        hi[l] |= static_cast<unsigned char>((bitmap[(h + 8) << 1 | l >> 3] >> (l & 7) & 1) << h);
+                    }
+                }
+            }
+
+            bool test(char c) const {
+                unsigned char u = static_cast<unsigned char>(c);
+                return bitmap[u >> 3] >> (u & 7) & 1;
+            }
+        };
+
+#if defined(STLENCODERS_SSSE3)
+        /*
+         * Shuffle masks moving the bytes of an 8-byte group selected
+         * by an 8-bit mask to the front, and the number of selected
+         * bytes.
+         */
+        struct skip_compress_table {
+            unsigned char shuffle[256][8];
+            unsigned char count[256];
+
+            skip_compress_table() {
+                for (int m = 0; m != 256; ++m) {
+                    int n = 0;
+                    for (int i = 0; i != 8; ++i) {
+                        if (m & 1 << i) {
+                            shuffle[m][n++] = static_cast<unsigned char>(i);
+                        }
+                    }
+                    count[m] = static_cast<unsigned char>(n);
+                    for (; n != 8; ++n) {
+                        shuffle[m][n] = 0x80;
+                    }
+                }
+            }
+
+            static const skip_compress_table& instance() {
+                static const skip_compress_table table;
+                return table;
+            }
+        };
+
+        /*
+         * Returns a mask with all bits set in the bytes of v that are
+         * to be removed, as described by the nibble tables lo and hi.
+         */
+        STLENCODERS_TARGET_SSSE3
+        inline __m128i skip_classify(__m128i v, __m128i lo, __m128i hi)
+        {
+            const __m128i nibble = _mm_set1_epi8(0x0f);
+            const __m128i pow2 = _mm_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+                );
+
+            __m128i l = _mm_and_si128(v, nibble);
+            __m128i h = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+            __m128i upper = _mm_cmpgt_epi8(h, _mm_set1_epi8(7));
+            __m128i row = _mm_or_si128(
+                _mm_and_si128(upper, _mm_shuffle_epi8(hi, l)),
+                _mm_andnot_si128(upper, _mm_shuffle_epi8(lo, l))
+                );
+            __m128i bit = _mm_shuffle_epi8(pow2, h);
+            return _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+        }
+
+        STLENCODERS_TARGET_SSSE3
+        inline std::size_t skip_compact_ssse3(
+            const char* src, std::size_t n, char* dst, std::size_t cap,
+            const skip_tables& skip, std::size_t& count
+            )
+        {
+            const skip_compress_table& table = skip_compress_table::instance();
+
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(skip.lo));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(skip.hi));
+
+            std::size_t i = 0, k = 0;
+            for (; n - i >= 16 && cap - k >= 16; i += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                unsigned keep = ~_mm_movemask_epi8(skip_classify(v, lo, hi)) & 0xffff;
+
+                if (keep == 0xffff) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), v);
+                    k += 16;
+                } else {
+                    unsigned m0 = keep & 0xff, m1 = keep >> 8;
+                    __m128i s0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.shuffle[m0]));
+                    __m128i s1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.shuffle[m1]));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), _mm_shuffle_epi8(v, s0));
+                    k += table.count[m0];
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + k), _mm_shuffle_epi8(_mm_srli_si128(v, 8), s1));
+                    k += table.count[m1];
+                }
+            }
+
+            count = k;
+            return i;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX512)
+        STLENCODERS_TARGET_AVX512
+        inline std::size_t skip_compact_avx512(
+            const char* src, std::size_t n, char* dst, std::size_t cap,
+            const skip_tables& skip, std::size_t& count
+            )
+        {
+            const __m512i lo = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(skip.lo)));
+            const __m512i hi = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(skip.hi)));
+            const __m512i nibble = _mm512_set1_epi8(0x0f);
+            const __m512i pow2 = _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+                ));
+
+            std::size_t i = 0, k = 0;
+            for (; n - i >= 64 && cap - k >= 64; i += 64) {
+                __m512i v = _mm512_loadu_si512(src + i);
+                __m512i l = _mm512_and_si512(v, nibble);
+                __m512i h = _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble);
+                __mmask64 upper = _mm512_cmpgt_epi8_mask(h, _mm512_set1_epi8(7));
+                __m512i row = _mm512_mask_blend_epi8(
+                    upper, _mm512_shuffle_epi8(lo, l), _mm512_shuffle_epi8(hi, l)
+                    );
+                __m512i bit = _mm512_shuffle_epi8(pow2, h);
+                __mmask64 keep = ~_mm512_test_epi8_mask(row, bit);
+
+                _mm512_storeu_si512(dst + k, _mm512_maskz_compress_epi8(keep, v));
+                k += popcount64(keep);
+            }
+
+            count = k;
+            return i;
+        }
+#endif
+
+        inline std::size_t skip_compact_scalar(
+            const char*, std::size_t, char*, std::size_t,
+            const skip_tables&, std::size_t& count
+            )
+        {
+            count = 0;
+            return 0;
+        }
+
+        struct skip_compact_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, char*, std::size_t,
+                const skip_tables&, std::size_t&
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return skip_compact_avx512;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return skip_compact_ssse3;
+                }
+#endif
+                return skip_compact_scalar;
+            }
+        };
+
+        /*
+         * Copies characters from [first, last) that are not to be
+         * removed to [dst, dst + cap) until either range is
+         * exhausted.  Returns the number of characters copied and
+         * advances first past the characters consumed.
+         */
+        inline std::size_t skip_compact(
+            const char*& first, const char* last, char* dst, std::size_t cap,
+            const skip_tables& skip
+            )
+        {
+            std::size_t k = 0;
+            first += dispatch<skip_compact_kernel>::get()(first, last - first, dst, cap, skip, k);
+
+            for (; first != last && k != cap; ++first) {
+                if (!skip.test(*first)) {
+                    dst[k++] = *first;
+                }
+            }
+
+            return k;
+        }
+
+        /*
+         * Forwards to a skip set as an opaque predicate.
+         */
+        class skip_set_predicate {
+        public:
+            explicit skip_set_predicate(const skip_set& s) : skip(s) { }
+
+            template<class charT>
+            bool operator()(const charT& c) const {
+                return skip(c);
+            }
+
+        private:
+            const skip_set& skip;
+        };
+
+        /*
+         * Returns the position of the k-th character in [first,
+         * last) that is not to be removed, or last if there are not
+         * that many.
+         */
+        inline const char* skip_position(
+            const char* first, const char* last, std::size_t k,
+            const skip_tables& skip
+            )
+        {
+            for (; first != last; ++first) {
+                if (!skip.test(*first) && k-- == 0) {
+                    break;
+                }
+            }
+            return first;
+        }
+
+        /*
+         * Decodes the contiguous range [first, last) of narrow
+         * characters, skipping the characters in skip.  Skipped
+         * characters are compacted out of the input in chunks, which
+         * are then decoded without skipping.  Each full chunk is a
+         * whole number of quanta, so decoding continues across chunks
+         * unless it stops within one, at padding or at an error; only
+         * that chunk is then rescanned to translate the offset back
+         * to the original input.
+         */
+        template<class Codec>
+        decode_result<unsigned char*> decode_skip_set(
+            const typename Codec::char_type* first,
+            const typename Codec::char_type* last,
+            unsigned char* result, const skip_set& skip
+            )
+        {
+            typedef typename Codec::char_type char_type;
+            typedef typename Codec::traits_type traits;
+
+            // without a block kernel, testing each character as it is
+            // decoded is faster than copying
+            if (dispatch<skip_compact_kernel>::get() == skip_compact_scalar) {
+                return Codec::try_decode(first, last, result, skip_set_predicate(skip));
+            }
+
+            const skip_tables tables(skip.data(), alphabet_bitmap<traits>::instance().value);
+
+            const char* src = reinterpret_cast<const char*>(first);
+            const char* end = reinterpret_cast<const char*>(last);
+            char buf[4096];
+
+            for (;;) {
+                const char* chunk = src;
+                std::size_t n = skip_compact(src, end, buf, sizeof buf, tables);
+                const char_type* p = reinterpret_cast<const char_type*>(buf);
+                decode_result<unsigned char*> r = Codec::try_decode(p, p + n, result);
+
+                if (r.status != decode_ok || r.offset != n) {
+                    const char* q = r.offset != n ? skip_position(chunk, src, r.offset, tables) : src;
+                    return make_decode_result(r.status, r.result, q - reinterpret_cast<const char*>(first));
+                }
+                if (src == end) {
+                    return make_decode_result(decode_ok, r.result, src - reinterpret_cast<const char*>(first));
+                }
+                result = r.result;
+            }
+        }
+    }
+}
+
+#endif
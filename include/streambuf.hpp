@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_STREAMBUF_HPP
+#define STLENCODERS_STREAMBUF_HPP
+
+#include "skip.hpp"
+
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Stream buffers that encode or decode data on its way to or from
+ * another stream buffer.
+ */
+namespace stlencoders {
+    /**
+     * An output stream buffer that encodes the octets written to it
+     * and writes the encoded characters to another stream buffer.
+     *
+     * Octets are collected in a 64 KiB put area and encoded a block
+     * at a time; larger writes are encoded directly from the
+     * caller's buffer.  sync() encodes all whole quanta written so
+     * far, while the octets of an incomplete quantum are carried
+     * over until close() encodes them, performing padding if the
+     * codec's encoder was constructed to do so.
+     *
+     * @tparam Codec the encoding class, e.g. base64<char>
+     */
+    template<class Codec>
+    class basic_encoding_streambuf : public std::streambuf {
+    public:
+        /**
+         * The encoding character type.
+         */
+        typedef typename Codec::char_type encoded_char_type;
+
+        /**
+         * The type of the underlying stream buffer.
+         */
+        typedef std::basic_streambuf<encoded_char_type> streambuf_type;
+
+        /**
+         * The stateful encoder type.
+         */
+        typedef typename Codec::encoder encoder_type;
+
+        /**
+         * Constructs an encoding stream buffer writing to @a sb.
+         *
+         * @param sb the underlying stream buffer
+         *
+         * @param encoder the encoder, e.g. to disable padding
+         */
+        explicit basic_encoding_streambuf(
+            streambuf_type* sb, const encoder_type& encoder = encoder_type()
+            )
+        : sb_(sb), encoder_(encoder), put_(block_size),
+          out_(Codec::max_encode_size(block_size + 8))
+        {
+            setp(&put_[0], &put_[0] + put_.size());
+        }
+
+        /**
+         * Closes the stream buffer, ignoring any errors.
+         */
+        ~basic_encoding_streambuf() {
+#if defined(STLENCODERS_EXCEPTIONS)
+            try {
+                close();
+            } catch (...) {
+            }
+#else
+            close();
+#endif
+        }
+
+        /**
+         * Encodes all octets written so far, including an incomplete
+         * quantum, and flushes the underlying stream buffer.
+         * Octets written afterwards start a new encoded character
+         * sequence.
+         *
+         * @return @c this, or a null pointer on failure
+         */
+        basic_encoding_streambuf* close() {
+            if (!encode_put_area()) {
+                return 0;
+            }
+            encoded_char_type* end = encoder_.finish(&out_[0]);
+            if (!write(end) || sb_->pubsync() == -1) {
+                return 0;
+            }
+            return this;
+        }
+
+    protected:
+        int_type overflow(int_type c) {
+            if (!encode_put_area()) {
+                return traits_type::eof();
+            }
+            if (traits_type::eq_int_type(c, traits_type::eof())) {
+                return traits_type::not_eof(c);
+            }
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+            return c;
+        }
+
+        std::streamsize xsputn(const char_type* s, std::streamsize n) {
+            if (n < epptr() - pptr()) {
+                return std::streambuf::xsputn(s, n);
+            }
+            if (!encode_put_area()) {
+                return 0;
+            }
+            for (std::streamsize i = 0; i != n; ) {
+                std::streamsize k = n - i < block_size ? n - i : std::streamsize(block_size);
+                if (!write(encoder_.update(s + i, s + i + k, &out_[0]))) {
+                    return i;
+                }
+                i += k;
+            }
+            return n;
+        }
+
+        int sync() {
+            return encode_put_area() ? sb_->pubsync() : -1;
+        }
+
+    private:
+        enum { block_size = 65536 };
+
+        bool encode_put_area() {
+            encoded_char_type* end = encoder_.update(pbase(), pptr(), &out_[0]);
+            setp(&put_[0], &put_[0] + put_.size());
+            return write(end);
+        }
+
+        bool write(encoded_char_type* end) {
+            std::streamsize n = end - &out_[0];
+            return sb_->sputn(&out_[0], n) == n;
+        }
+
+        streambuf_type* sb_;
+        encoder_type encoder_;
+        std::vector<char_type> put_;
+        std::vector<encoded_char_type> out_;
+
+        // not copyable
+        basic_encoding_streambuf(const basic_encoding_streambuf&);
+        basic_encoding_streambuf& operator=(const basic_encoding_streambuf&);
+    };
+
+    /**
+     * An input stream buffer that reads encoded characters from
+     * another stream buffer and provides the decoded octets.
+     *
+     * Characters are read and decoded 64 KiB at a time into the get
+     * area; larger reads are decoded directly into the caller's
+     * buffer.  The end of the underlying stream ends the encoded
+     * character sequence, and decoding errors are reported by
+     * throwing invalid_character or invalid_length from underflow()
+     * or xsgetn().
+     *
+     * @tparam Codec the encoding class, e.g. base64<char>
+     *
+     * @tparam Predicate a predicate type for characters to be
+     * skipped; the default skips none
+     */
+    template<class Codec, class Predicate = skip_set>
+    class basic_decoding_streambuf : public std::streambuf {
+    public:
+        /**
+         * The encoding character type.
+         */
+        typedef typename Codec::char_type encoded_char_type;
+
+        /**
+         * The type of the underlying stream buffer.
+         */
+        typedef std::basic_streambuf<encoded_char_type> streambuf_type;
+
+        /**
+         * Constructs a decoding stream buffer reading from @a sb.
+         *
+         * @param sb the underlying stream buffer
+         *
+         * @param skip a function object that, when applied to a
+         * value of type encoded_char_type, returns a value testable
+         * as @c true for characters to be ignored
+         */
+        explicit basic_decoding_streambuf(
+            streambuf_type* sb, Predicate skip = Predicate()
+            )
+        : sb_(sb), skip_(skip), in_(block_size),
+          get_(Codec::max_decode_size(block_size + 8)), eof_(false)
+        {
+            setg(&get_[0], &get_[0], &get_[0]);
+        }
+
+    protected:
+        int_type underflow() {
+            if (gptr() == egptr()) {
+                std::streamsize n = 0;
+                while (n == 0 && !eof_) {
+                    n = decode(&get_[0]);
+                }
+                setg(&get_[0], &get_[0], &get_[0] + n);
+            }
+            return gptr() != egptr() ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+        }
+
+        std::streamsize xsgetn(char_type* s, std::streamsize n) {
+            std::streamsize i = egptr() - gptr() < n ? egptr() - gptr() : n;
+            traits_type::copy(s, gptr(), static_cast<std::size_t>(i));
+            gbump(static_cast<int>(i));
+
+            while (n - i >= static_cast<std::streamsize>(get_.size()) && !eof_) {
+                i += decode(s + i);
+            }
+            return i + std::streambuf::xsgetn(s + i, n - i);
+        }
+
+    private:
+        enum { block_size = 65536 };
+
+        /*
+         * Reads a block of encoded characters and decodes it into
+         * dst, which must have room for get_.size() octets.
+         */
+        std::streamsize decode(char_type* dst) {
+            std::streamsize n = sb_->sgetn(&in_[0], in_.size());
+            char_type* end = decoder_.update(&in_[0], &in_[0] + n, dst, skip_);
+            if (n != static_cast<std::streamsize>(in_.size())) {
+                eof_ = true;
+                end = decoder_.finish(end);
+            }
+            return end - dst;
+        }
+
+        streambuf_type* sb_;
+        typename Codec::decoder decoder_;
+        Predicate skip_;
+        std::vector<encoded_char_type> in_;
+        std::vector<char_type> get_;
+        bool eof_;
+
+        // not copyable
+        basic_decoding_streambuf(const basic_decoding_streambuf&);
+        basic_decoding_streambuf& operator=(const basic_decoding_streambuf&);
+    };
+}
+
+#endif
@@ -209,6 +209,42 @@ namespace stlencoders {
             return traits::to_char_type_upper(c);
         }
     };
+
+    namespace detail {
+        /*
+         * Character classes used by table-driven decoders.
+         */
+        enum char_class {
+            alphabet_class, pad_class, skip_class, invalid_class
+        };
+
+        /*
+         * Pairs of encoding characters for all values of 2 * Bits
+         * bits, built from the encoding traits on first use.  Since
+         * the table is built through traits::to_char_type(), the
+         * lowercase and uppercase adaptors get tables of their own.
+         */
+        template<class traits, int Bits>
+        struct pair_table {
+            typedef typename traits::char_type char_type;
+
+            enum { size = 1 << (2 * Bits), mask = (1 << Bits) - 1 };
+
+            char_type value[size][2];
+
+            pair_table() {
+                for (int i = 0; i != size; ++i) {
+                    value[i][0] = traits::to_char_type(i >> Bits);
+                    value[i][1] = traits::to_char_type(i & mask);
+                }
+            }
+
+            static const pair_table& instance() {
+                static const pair_table table;
+                return table;
+            }
+        };
+    }
 }
 
 #endif
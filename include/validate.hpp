@@ -0,0 +1,447 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef STLENCODERS_VALIDATE_HPP
+#define STLENCODERS_VALIDATE_HPP
+
+#include "contiguous.hpp"
+#include "dispatch.hpp"
+#include "error.hpp"
+#include "simd.hpp"
+#include "skip.hpp"
+
+#include <cstddef>
+#include <iterator>
+
+/**
+ * @file
+ *
+ * Validation of encoded character ranges without decoding.
+ */
+namespace stlencoders {
+    namespace detail {
+        /*
+         * Tables for validating narrow characters.  category holds 0
+         * for characters in the encoding alphabet, 1 for characters
+         * to be skipped and 2 for characters that end validation.
+         * If no character with the high bit set is accepted, accept
+         * and skip also describe the accepted and skipped characters
+         * for a vectorized lookup: bit h of accept[l] is set if the
+         * character with high nibble h and low nibble l is accepted.
+         */
+        struct validate_tables {
+            unsigned char category[256];
+            unsigned char accept[16];
+            unsigned char skip[16];
+            bool ascii;
+            bool skipping;
+
+            validate_tables(const unsigned char* s, const unsigned char* alphabet)
+            : ascii(true), skipping(false)
+            {
+                for (int c = 0; c != 256; ++c) {
+                    bool a = alphabet[c >> 3] >> (c & 7) & 1;
+                    bool k = !a && (s[c >> 3] >> (c & 7) & 1);
+                    category[c] = static_cast<unsigned char>(a ? 0 : k ? 1 : 2);
+                    ascii = ascii && (c < 0x80 || category[c] == 2);
+                    skipping = skipping || k;
+                }
+                for (int l = 0; l != 16; ++l) {
+                    accept[l] = skip[l] = 0;
+                    for (int h = 0; h != 8; ++h) {
+                        accept[l] |= static_cast<unsigned char>((category[h << 4 | l] != 2) << h);
+                        skip[l] |= static_cast<unsigned char>((category[h << 4 | l] == 1) << h);
+                    }
+                }
+            }
+        };
+
+        /*
+         * Validation tables for an empty skip set, built from the
+         * encoding traits on first use.
+         */
+        template<class traits>
+        struct alphabet_tables {
+            static const validate_tables& instance() {
+                static const unsigned char none[32] = { 0 };
+                static const validate_tables tables(none, alphabet_bitmap<traits>::instance().value);
+                return tables;
+            }
+        };
+
+        /*
+         * The block kernels scan 64 characters at a time, returning
+         * the number of characters before the first one that ends
+         * validation, or the number of characters in whole blocks.
+         */
+#if defined(STLENCODERS_SSSE3)
+        /*
+         * Returns a mask with the bits set for the characters in the
+         * 64-byte block at src that are not in the set described by
+         * table.
+         */
+        STLENCODERS_TARGET_SSSE3
+        inline unsigned long long validate_mask_ssse3(const char* src, __m128i table)
+        {
+            const __m128i nibble = _mm_set1_epi8(0x0f);
+            const __m128i pow2 = _mm_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+                );
+
+            unsigned long long m = 0;
+            for (int j = 0; j != 64; j += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + j));
+                __m128i bit = _mm_shuffle_epi8(pow2, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+                __m128i row = _mm_shuffle_epi8(table, v);
+                __m128i out = _mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128());
+                m |= static_cast<unsigned long long>(_mm_movemask_epi8(out) & 0xffff) << j;
+            }
+            return m;
+        }
+
+        STLENCODERS_TARGET_SSSE3
+        inline std::size_t validate_span_ssse3(
+            const char* src, std::size_t n, const validate_tables& t,
+            std::size_t& skipped
+            )
+        {
+            const __m128i accept = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.accept));
+            const __m128i skip = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.skip));
+
+            std::size_t i = 0;
+            for (; n - i >= 64; i += 64) {
+                unsigned long long stop = validate_mask_ssse3(src + i, accept);
+                unsigned long long k = t.skipping ? ~validate_mask_ssse3(src + i, skip) : 0;
+                if (stop != 0) {
+                    std::size_t j = ctz64(stop);
+                    skipped += popcount64(k & ((1ULL << j) - 1));
+                    return i + j;
+                }
+                skipped += popcount64(k);
+            }
+            return i;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX2)
+        STLENCODERS_TARGET_AVX2
+        inline unsigned long long validate_mask_avx2(const char* src, __m256i table)
+        {
+            const __m256i nibble = _mm256_set1_epi8(0x0f);
+            const __m256i pow2 = _mm256_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+                );
+
+            unsigned long long m = 0;
+            for (int j = 0; j != 64; j += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + j));
+                __m256i bit = _mm256_shuffle_epi8(pow2, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+                __m256i row = _mm256_shuffle_epi8(table, v);
+                __m256i out = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256());
+                m |= static_cast<unsigned long long>(static_cast<unsigned>(_mm256_movemask_epi8(out))) << j;
+            }
+            return m;
+        }
+
+        STLENCODERS_TARGET_AVX2
+        inline std::size_t validate_span_avx2(
+            const char* src, std::size_t n, const validate_tables& t,
+            std::size_t& skipped
+            )
+        {
+            const __m256i accept = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.accept)));
+            const __m256i skip = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.skip)));
+
+            std::size_t i = 0;
+            for (; n - i >= 64; i += 64) {
+                unsigned long long stop = validate_mask_avx2(src + i, accept);
+                unsigned long long k = t.skipping ? ~validate_mask_avx2(src + i, skip) : 0;
+                if (stop != 0) {
+                    std::size_t j = ctz64(stop);
+                    skipped += popcount64(k & ((1ULL << j) - 1));
+                    return i + j;
+                }
+                skipped += popcount64(k);
+            }
+            return i;
+        }
+#endif
+
+#if defined(STLENCODERS_AVX512)
+        STLENCODERS_TARGET_AVX512
+        inline std::size_t validate_span_avx512(
+            const char* src, std::size_t n, const validate_tables& t,
+            std::size_t& skipped
+            )
+        {
+            const __m512i nibble = _mm512_set1_epi8(0x0f);
+            const __m512i pow2 = _mm512_maskz_broadcast_i32x4(0xffff, _mm_setr_epi8(
+                1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+                ));
+            const __m512i accept = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.accept)));
+            const __m512i skip = _mm512_maskz_broadcast_i32x4(0xffff, _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.skip)));
+
+            std::size_t i = 0;
+            for (; n - i >= 64; i += 64) {
+                __m512i v = _mm512_loadu_si512(src + i);
+                __m512i bit = _mm512_shuffle_epi8(pow2, _mm512_and_si512(_mm512_srli_epi16(v, 4), nibble));
+                unsigned long long stop = _mm512_testn_epi8_mask(_mm512_shuffle_epi8(accept, v), bit);
+                unsigned long long k = t.skipping ? _mm512_test_epi8_mask(_mm512_shuffle_epi8(skip, v), bit) : 0;
+                if (stop != 0) {
+                    std::size_t j = ctz64(stop);
+                    skipped += popcount64(k & ((1ULL << j) - 1));
+                    return i + j;
+                }
+                skipped += popcount64(k);
+            }
+            return i;
+        }
+#endif
+
+        inline std::size_t validate_span_scalar(
+            const char*, std::size_t, const validate_tables&, std::size_t&
+            )
+        {
+            return 0;
+        }
+
+        struct validate_span_kernel {
+            typedef std::size_t (*function_type)(
+                const char*, std::size_t, const validate_tables&, std::size_t&
+                );
+
+            static function_type select(simd_level level) {
+#if defined(STLENCODERS_AVX512)
+                if (level >= simd_avx512) {
+                    return validate_span_avx512;
+                }
+#endif
+#if defined(STLENCODERS_AVX2)
+                if (level >= simd_avx2) {
+                    return validate_span_avx2;
+                }
+#endif
+#if defined(STLENCODERS_SSSE3)
+                if (level >= simd_ssse3) {
+                    return validate_span_ssse3;
+                }
+#endif
+                return validate_span_scalar;
+            }
+        };
+
+        /*
+         * Returns the number of characters at the start of [first,
+         * first + n) that are in the encoding alphabet or to be
+         * skipped, and adds the number of the latter to skipped.
+         */
+        inline std::size_t validate_span(
+            const char* first, std::size_t n, const validate_tables& t,
+            std::size_t& skipped
+            )
+        {
+            std::size_t i = 0;
+            if (t.ascii) {
+                i = dispatch<validate_span_kernel>::get()(first, n, t, skipped);
+            }
+
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(first);
+            for (; n - i >= 8; i += 8) {
+                unsigned c0 = t.category[p[i + 0]], c1 = t.category[p[i + 1]];
+                unsigned c2 = t.category[p[i + 2]], c3 = t.category[p[i + 3]];
+                unsigned c4 = t.category[p[i + 4]], c5 = t.category[p[i + 5]];
+                unsigned c6 = t.category[p[i + 6]], c7 = t.category[p[i + 7]];
+                if ((c0 | c1 | c2 | c3 | c4 | c5 | c6 | c7) & 2) {
+                    break;
+                }
+                skipped += c0 + c1 + c2 + c3 + c4 + c5 + c6 + c7;
+            }
+            for (; i != n; ++i) {
+                unsigned char c = t.category[p[i]];
+                if (c == 2) {
+                    break;
+                }
+                skipped += c;
+            }
+            return i;
+        }
+
+        /*
+         * Predicate for validation without skipping characters.
+         */
+        struct skip_none {
+            template<class charT>
+            bool operator()(const charT&) const {
+                return false;
+            }
+        };
+
+        /*
+         * Validates a range of encoding characters as the codec's
+         * decode() would, without producing output: validation stops
+         * at the first character neither in the encoding alphabet
+         * nor to be skipped, and the number of alphabet characters
+         * before it must leave no trailing character contributing no
+         * whole octet.  Padded tells whether traits_type::pad() ends
+         * the encoded data.  Contiguous ranges of narrow characters
+         * are scanned with a block kernel when no predicate or a
+         * skip_set is given.
+         */
+        template<class Codec, int Bits, int Chars, bool Padded>
+        class validator {
+        public:
+            typedef typename Codec::char_type char_type;
+
+            typedef typename Codec::traits_type traits_type;
+
+            template<class InputIterator, class Predicate>
+            static validate_result validate(
+                InputIterator first, InputIterator last, Predicate& skip
+                )
+            {
+                std::size_t skipped = 0;
+                std::size_t n = scan(first, last, skip, skipped);
+
+                decode_status status;
+                if (first != last && !padding(*first, bool_constant<Padded>())) {
+                    status = decode_invalid_character;
+                } else if (!valid_length((n - skipped) % Chars)) {
+                    status = decode_invalid_length;
+                } else {
+                    status = decode_ok;
+                }
+                validate_result r = { status, n };
+                return r;
+            }
+
+            /*
+             * Advances first to the first character neither in the
+             * encoding alphabet nor to be skipped, or to last.
+             * Returns the number of characters passed, and adds the
+             * number of skipped ones to skipped.
+             */
+            template<class InputIterator, class Predicate>
+            static std::size_t scan(
+                InputIterator& first, const InputIterator& last, Predicate& skip,
+                std::size_t& skipped
+                )
+            {
+                typedef bool_constant<
+                    is_byte<char_type>::value &&
+                    is_contiguous_bytes<InputIterator>::value
+                    > tag;
+                return scan(first, last, skip, skipped, tag());
+            }
+
+            /*
+             * Tests whether c is in the encoding alphabet, to be
+             * skipped, or ends validation, in which case it returns
+             * 0, 1 or 2, respectively.
+             */
+            template<class Predicate>
+            static int category(char_type c, Predicate& skip) {
+                if (!traits_type::eq_int_type(traits_type::to_int_type(c), traits_type::inv())) {
+                    return 0;
+                } else if (skip(c)) {
+                    return 1;
+                } else {
+                    return 2;
+                }
+            }
+
+        private:
+            template<class InputIterator, class Predicate>
+            static std::size_t scan(
+                InputIterator& first, const InputIterator& last, Predicate& skip,
+                std::size_t& skipped, false_type
+                )
+            {
+                std::size_t n = 0;
+                for (; first != last; ++first, ++n) {
+                    int c = category(*first, skip);
+                    if (c == 2) {
+                        break;
+                    }
+                    skipped += c;
+                }
+                return n;
+            }
+
+            template<class InputIterator, class Predicate>
+            static std::size_t scan(
+                InputIterator& first, const InputIterator& last, Predicate& skip,
+                std::size_t& skipped, true_type
+                )
+            {
+                const char* src = address<const char>(first);
+                typedef bool_constant<is_skip_set<Predicate>::value> skip_set_tag;
+                std::size_t n = scan_contiguous(src, last - first, skip, skipped, skip_set_tag());
+                std::advance(first, n);
+                return n;
+            }
+
+            template<class Predicate>
+            static std::size_t scan_contiguous(
+                const char* first, std::size_t n, Predicate& skip,
+                std::size_t& skipped, false_type
+                )
+            {
+                const char_type* p = reinterpret_cast<const char_type*>(first);
+                return scan(p, p + n, skip, skipped, false_type());
+            }
+
+            static std::size_t scan_contiguous(
+                const char* first, std::size_t n, skip_none&,
+                std::size_t& skipped, false_type
+                )
+            {
+                return validate_span(first, n, alphabet_tables<traits_type>::instance(), skipped);
+            }
+
+            static std::size_t scan_contiguous(
+                const char* first, std::size_t n, const skip_set& skip,
+                std::size_t& skipped, true_type
+                )
+            {
+                const validate_tables tables(skip.data(), alphabet_bitmap<traits_type>::instance().value);
+                return validate_span(first, n, tables, skipped);
+            }
+
+            // a trailing character contributing no whole octet
+            static bool valid_length(std::size_t n) {
+                return n == 0 || n * Bits / 8 != (n - 1) * Bits / 8;
+            }
+
+            static bool padding(char_type c, true_type) {
+                return traits_type::eq(c, traits_type::pad());
+            }
+
+            static bool padding(char_type, false_type) {
+                return false;
+            }
+        };
+    }
+}
+
+#endif
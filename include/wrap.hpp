@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef STLENCODERS_WRAP_HPP
+#define STLENCODERS_WRAP_HPP
+
+#include "iterator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ *
+ * Common implementation of line-wrapping encoders.
+ */
+namespace stlencoders {
+    namespace detail {
+        inline std::size_t gcd(std::size_t a, std::size_t b)
+        {
+            while (b != 0) {
+                std::size_t t = a % b;
+                a = b;
+                b = t;
+            }
+            return a;
+        }
+
+        /*
+         * The maximum number of characters buffered by
+         * encode_wrapped() for lines not holding a whole number of
+         * quanta.
+         */
+        const std::size_t max_wrap_buffer = 1 << 16;
+
+        /*
+         * Returns the length of an encoded character sequence of n
+         * characters after inserting a delimiter of length eol
+         * between lines of cols characters.
+         */
+        template<class sizeT>
+        sizeT wrapped_size(sizeT n, sizeT cols, sizeT eol)
+        {
+            return cols == 0 || n == 0 ? n : n + (n - 1) / cols * eol;
+        }
+
+        /*
+         * Encodes a range of octets using encoder, which maps
+         * quanta of octets octets to chars characters, inserting
+         * the delimiter eol between lines of cols characters.
+         *
+         * Ranges that cannot be split are encoded through a
+         * line_wrap_iterator.
+         */
+        template<class Encoder, class InputIterator, class OutputIterator, class charT>
+        OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const charT* eol, Encoder encoder,
+            std::size_t, std::size_t, std::input_iterator_tag
+            )
+        {
+            if (cols == 0) {
+                return encoder(first, last, result);
+            }
+            return encoder(first, last, line_wrapper(result, cols, eol)).base();
+        }
+
+        /*
+         * Random access ranges are encoded a line at a time if a line
+         * holds a whole number of quanta.  Otherwise, as many lines
+         * as it takes to end on a quantum boundary are encoded to a
+         * buffer at a time, and copied from there, unless that
+         * buffer would exceed max_wrap_buffer characters.
+         */
+        template<class Encoder, class InputIterator, class OutputIterator, class charT>
+        OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const charT* eol, Encoder encoder,
+            std::size_t chars, std::size_t octets,
+            std::random_access_iterator_tag
+            )
+        {
+            if (cols == 0) {
+                return encoder(first, last, result);
+            }
+
+            const charT* eol_end = eol + std::char_traits<charT>::length(eol);
+            const std::size_t lines = chars / gcd(cols, chars);
+            const std::size_t n = cols * lines / chars * octets;
+
+            if (lines == 1) {
+                for (; static_cast<std::size_t>(last - first) > n; first += n) {
+                    result = encoder(first, first + n, result);
+                    result = std::copy(eol, eol_end, result);
+                }
+                return encoder(first, last, result);
+            }
+
+            if (cols > max_wrap_buffer / lines) {
+                return encode_wrapped(first, last, result, cols, eol, encoder, chars, octets, std::input_iterator_tag());
+            }
+
+            const std::size_t size = (static_cast<std::size_t>(last - first) + octets - 1) / octets * chars;
+            std::vector<charT> buf(std::max(std::min(cols * lines, size), std::size_t(1)));
+
+            for (;;) {
+                const bool more = static_cast<std::size_t>(last - first) > n;
+                InputIterator next = more ? first + n : last;
+                std::size_t k = encoder(first, next, &buf[0]) - &buf[0];
+
+                for (std::size_t i = 0; i < k; i += cols) {
+                    if (i != 0) {
+                        result = std::copy(eol, eol_end, result);
+                    }
+                    result = std::copy(&buf[i], &buf[0] + std::min(i + cols, k), result);
+                }
+
+                if (!more) {
+                    return result;
+                }
+                result = std::copy(eol, eol_end, result);
+                first = next;
+            }
+        }
+
+        template<class Encoder, class InputIterator, class OutputIterator, class charT>
+        OutputIterator encode_wrapped(
+            InputIterator first, InputIterator last, OutputIterator result,
+            std::size_t cols, const charT* eol, Encoder encoder,
+            std::size_t chars, std::size_t octets
+            )
+        {
+            typename std::iterator_traits<InputIterator>::iterator_category tag;
+            return encode_wrapped(first, last, result, cols, eol, encoder, chars, octets, tag);
+        }
+    }
+}
+
+#endif
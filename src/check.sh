@@ -13,6 +13,9 @@ die () {
     exit 1
 }
 
+TMP=$(mktemp) || die "cannot create temporary file"
+trap 'rm -f "$TMP"' EXIT
+
 for file in "${@:-$0}"; do
     echo "$0: checking '$file'" >&2
     for base in base2 base16 base32 base32hex base64 base64url; do
@@ -20,6 +23,19 @@ for file in "${@:-$0}"; do
             || die "$file: $base error"
     done
 
+    for backend in auto write; do
+        $STLENCODE -b $backend "$file" > "$TMP" \
+            || die "$file: $backend encode error"
+        $STLDECODE -b $backend "$TMP" > "$TMP.out" && $CMP "$file" "$TMP.out" \
+            || die "$file: $backend decode error"
+        rm -f "$TMP.out"
+    done
+
+    if [ -n "$($STLENCODE -b splice "$0" 2> /dev/null)" ]; then
+        $STLENCODE -b splice "$file" | $STLDECODE -b splice | cat | $CMP "$file" \
+            || die "$file: splice error"
+    fi
+
     if [ -x "$BASE64" ]; then
         $BASE64 "$file" | $STLDECODE -c base64 | $CMP "$file" \
             || die "$file: base64 decode error"
@@ -0,0 +1,730 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "parallel.hpp"
+#include "uring.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#if defined(STLENCODERS_THREADS)
+# include <exception>
+# include <thread>
+#endif
+
+#if defined(HAVE_VMSPLICE) || defined(HAVE_IO_URING)
+# include <cerrno>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif
+
+namespace {
+    // number of reads kept in flight per input block with io_uring
+    const std::size_t uring_reads = 8;
+
+    // size of the writes kept in flight with io_uring
+    const std::size_t uring_window = 1 << 22;
+
+    /*
+     * Input and output backends.
+     */
+    enum io_backend {
+        backend_auto,
+        backend_write,
+        backend_splice,
+        backend_uring
+    };
+
+    io_backend parse_backend(const std::string& name)
+    {
+        if (name == "auto") {
+            return backend_auto;
+        } else if (name == "write") {
+            return backend_write;
+        } else if (name == "splice") {
+            return backend_splice;
+        } else if (name == "uring") {
+            return backend_uring;
+        } else {
+            throw std::runtime_error("unknown backend: '" + name + "'");
+        }
+    }
+
+    /*
+     * Reads up to n characters from a stream buffer, returning
+     * fewer only at the end of the input.
+     */
+    std::size_t read_block(std::streambuf* sb, char* s, std::size_t n)
+    {
+        std::size_t size = 0;
+        for (std::streamsize m; size != n && (m = sb->sgetn(s + size, n - size)) > 0; ) {
+            size += m;
+        }
+        return size;
+    }
+
+    /*
+     * Returns the largest number of jobs worth running, so that the
+     * memory used for the blocks of all jobs stays bounded.
+     */
+    std::size_t max_jobs()
+    {
+#if defined(STLENCODERS_THREADS)
+        std::size_t n = std::thread::hardware_concurrency();
+        return 2 * (n != 0 ? n : 1);
+#else
+        return 1;
+#endif
+    }
+
+    /*
+     * Reads the input file, or standard input if filename is "-",
+     * through a stream buffer or, if backend is backend_uring and
+     * the input is a regular file, with several io_uring(7) reads
+     * in flight per block.
+     */
+    class input_reader {
+    public:
+        input_reader(const char* filename, io_backend backend)
+        : sb_(0), fd_(-1), offset_(0)
+        {
+            bool is_stdin = std::strcmp(filename, "-") == 0;
+#if defined(HAVE_IO_URING)
+            ring_ = 0;
+            struct stat st;
+            int r = is_stdin ? fstat(STDIN_FILENO, &st) : stat(filename, &st);
+            if (backend == backend_uring && r == 0 && S_ISREG(st.st_mode)) {
+                fd_ = is_stdin ? STDIN_FILENO : open(filename, O_RDONLY);
+                if (fd_ < 0) {
+                    throw std::runtime_error("cannot open file");
+                }
+                off_t offset = lseek(fd_, 0, SEEK_CUR);
+                offset_ = offset < 0 ? 0 : offset;
+                try {
+                    ring_ = new io_ring(uring_reads);
+                    return;
+                } catch (std::runtime_error&) {
+                    close();
+                }
+            }
+#else
+            static_cast<void>(backend);
+#endif
+            if (is_stdin) {
+                sb_ = std::cin.rdbuf();
+            } else if (fb_.open(filename, std::ios::in | std::ios::binary)) {
+                sb_ = &fb_;
+            } else {
+                throw std::runtime_error("cannot open file");
+            }
+        }
+
+        ~input_reader() {
+            close();
+        }
+
+        /*
+         * Reads up to n characters, returning fewer only at the end
+         * of the input.
+         */
+        std::size_t read(char* s, std::size_t n) {
+#if defined(HAVE_IO_URING)
+            if (ring_) {
+                return read_ring(s, n);
+            }
+#endif
+            return read_block(sb_, s, n);
+        }
+
+    private:
+        input_reader(const input_reader&);
+        input_reader& operator=(const input_reader&);
+
+#if defined(HAVE_IO_URING)
+        std::size_t read_ring(char* s, std::size_t n) {
+            std::size_t piece = std::max<std::size_t>((n + uring_reads - 1) / uring_reads, 1 << 16);
+            std::size_t count = (n + piece - 1) / piece;
+            for (std::size_t i = 0; i != count; ++i) {
+                std::size_t len = std::min(piece, n - i * piece);
+                ring_->submit(IORING_OP_READ, fd_, s + i * piece, len, offset_ + i * piece, i);
+            }
+            std::vector<int> res(count);
+            for (std::size_t i = 0; i != count; ++i) {
+                io_uring_cqe cqe = ring_->wait();
+                res[cqe.user_data] = cqe.res;
+            }
+
+            std::size_t size = 0;
+            for (std::size_t i = 0; i != count && size == i * piece; ++i) {
+                if (res[i] < 0) {
+                    throw std::runtime_error(std::strerror(-res[i]));
+                }
+                size += res[i];
+            }
+            // a short read need not be the end of the input
+            while (size != n) {
+                ssize_t m = pread(fd_, s + size, n - size, offset_ + size);
+                if (m < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::strerror(errno));
+                } else if (m == 0) {
+                    break;
+                }
+                size += m < 0 ? 0 : m;
+            }
+            offset_ += size;
+            return size;
+        }
+#endif
+
+        void close() {
+#if defined(HAVE_IO_URING)
+            if (fd_ == STDIN_FILENO) {
+                // leave standard input where reading stopped
+                lseek(fd_, offset_, SEEK_SET);
+            } else if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            fd_ = -1;
+            delete ring_;
+            ring_ = 0;
+#endif
+        }
+
+        std::streambuf* sb_;
+        std::filebuf fb_;
+        int fd_;
+        unsigned long long offset_;
+#if defined(HAVE_IO_URING)
+        io_ring* ring_;
+#endif
+    };
+
+    /*
+     * Writes characters to standard output through its stream
+     * buffer, by mapping the pages holding them into a pipe with
+     * vmsplice(2), or with io_uring(7) writes kept in flight.
+     * backend_auto picks io_uring if standard output is a regular
+     * file, and the stream buffer otherwise.
+     *
+     * In the latter two cases the kernel keeps referring to the
+     * caller's memory after write() has returned, so a buffer must
+     * not be modified before retained() more characters have been
+     * written after it, counting whole multiples of alignment() for
+     * each buffer.  With vmsplice(2), this only holds for readers
+     * that copy the data out of the pipe; one that moves the pages
+     * on with splice(2) or tee(2) may still see them after they have
+     * been reused, which is why splicing is never chosen by
+     * backend_auto.  finish() waits for all writes to complete.
+     */
+    class output_writer {
+    public:
+        output_writer(std::streambuf* sb, io_backend backend)
+        : sb_(sb), backend_(backend)
+        {
+#if defined(HAVE_IO_URING)
+            ring_ = 0;
+            offset_ = first_ = 0;
+            error_ = 0;
+            struct stat st;
+            int flags = fcntl(STDOUT_FILENO, F_GETFL);
+            bool regular = fstat(STDOUT_FILENO, &st) == 0 && S_ISREG(st.st_mode);
+            if (backend_ == backend_auto) {
+                backend_ = backend_write;
+                if (regular && flags >= 0 && !(flags & O_APPEND)) {
+                    try {
+                        ring_ = new io_ring(uring_entries);
+                        backend_ = backend_uring;
+                    } catch (std::runtime_error&) { }
+                }
+            } else if (backend_ == backend_uring) {
+                if (!regular) {
+                    throw std::runtime_error("standard output is not a regular file");
+                }
+                if (flags < 0 || (flags & O_APPEND)) {
+                    throw std::runtime_error("standard output is opened for appending");
+                }
+                ring_ = new io_ring(uring_entries);
+            }
+            if (backend_ == backend_uring) {
+                off_t offset = lseek(STDOUT_FILENO, 0, SEEK_CUR);
+                offset_ = offset < 0 ? 0 : offset;
+            }
+#else
+            if (backend_ == backend_auto) {
+                backend_ = backend_write;
+            } else if (backend_ == backend_uring) {
+                throw std::runtime_error("io_uring output not supported");
+            }
+#endif
+
+#if defined(HAVE_VMSPLICE)
+            if (backend_ == backend_splice) {
+                struct stat st;
+                if (fstat(STDOUT_FILENO, &st) != 0 || !S_ISFIFO(st.st_mode)) {
+                    throw std::runtime_error("standard output is not a pipe");
+                }
+                // fewer, larger vmsplice() calls; failure is harmless
+                fcntl(STDOUT_FILENO, F_SETPIPE_SZ, 1 << 20);
+            }
+#else
+            if (backend_ == backend_splice) {
+                throw std::runtime_error("splice output not supported");
+            }
+#endif
+        }
+
+        ~output_writer() {
+#if defined(HAVE_IO_URING)
+            if (ring_) {
+                try {
+                    drain();
+                } catch (std::exception&) { }
+                delete ring_;
+            }
+#endif
+        }
+
+        /*
+         * Returns the backend in use, which is never backend_auto.
+         */
+        io_backend backend() const {
+            return backend_;
+        }
+
+        void write(const char* first, const char* last) {
+#if defined(HAVE_VMSPLICE)
+            while (backend_ == backend_splice && first != last) {
+                struct iovec iov;
+                iov.iov_base = const_cast<char*>(first);
+                iov.iov_len = last - first;
+                ssize_t n = vmsplice(STDOUT_FILENO, &iov, 1, 0);
+                if (n < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::strerror(errno));
+                }
+                first += n < 0 ? 0 : n;
+            }
+#endif
+#if defined(HAVE_IO_URING)
+            if (backend_ == backend_uring) {
+                return submit(first, last);
+            }
+#endif
+            if (sb_->sputn(first, last - first) != last - first) {
+                throw std::runtime_error("write error");
+            }
+        }
+
+        /*
+         * Waits for all writes to complete, so that their buffers
+         * may be modified, throwing if any failed.
+         */
+        void sync() {
+#if defined(HAVE_IO_URING)
+            if (backend_ == backend_uring) {
+                drain();
+                check();
+            }
+#endif
+        }
+
+        /*
+         * Waits for all writes to complete and flushes the stream
+         * buffer, throwing if any failed.
+         */
+        void finish() {
+#if defined(HAVE_IO_URING)
+            if (backend_ == backend_uring) {
+                drain();
+                // leave standard output where writing stopped
+                lseek(STDOUT_FILENO, offset_, SEEK_SET);
+                check();
+                return;
+            }
+#endif
+            if (sb_->pubsync() != 0) {
+                throw std::runtime_error("write error");
+            }
+        }
+
+        /*
+         * Returns the number of characters that must be written
+         * after a buffer before it may be modified.
+         */
+        std::size_t retained() const {
+#if defined(HAVE_VMSPLICE)
+            if (backend_ == backend_splice) {
+                // the pipe may have been resized by anyone holding it
+                int n = fcntl(STDOUT_FILENO, F_GETPIPE_SZ);
+                if (n < 0) {
+                    throw std::runtime_error(std::strerror(errno));
+                }
+                return n;
+            }
+#endif
+            return backend_ == backend_uring ? uring_window : 0;
+        }
+
+        /*
+         * Returns the alignment of buffers that do not share pages
+         * with others.
+         */
+        std::size_t alignment() const {
+#if defined(HAVE_VMSPLICE)
+            return backend_ == backend_splice ? sysconf(_SC_PAGESIZE) : 1;
+#else
+            return 1;
+#endif
+        }
+
+    private:
+        output_writer(const output_writer&);
+        output_writer& operator=(const output_writer&);
+
+#if defined(HAVE_IO_URING)
+        // number of io_uring writes that may be in flight
+        static const unsigned uring_entries = 64;
+
+        struct request {
+            const char* data;
+            std::size_t size;
+            unsigned long long offset;
+            bool done;
+        };
+
+        void submit(const char* first, const char* last) {
+            check();
+            if (first == last) {
+                return;
+            }
+            while (requests_.size() == ring_->entries()) {
+                reap();
+            }
+            request r = { first, std::size_t(last - first), offset_, false };
+            ring_->submit(IORING_OP_WRITE, STDOUT_FILENO, r.data, r.size, r.offset, first_ + requests_.size());
+            requests_.push_back(r);
+            offset_ += r.size;
+
+            // writes ending uring_window characters back must be done
+            while (!requests_.empty() && requests_.front().offset + requests_.front().size + uring_window <= offset_) {
+                reap();
+            }
+            check();
+        }
+
+        /*
+         * Waits for a write to complete, finishing it synchronously
+         * if it came up short, and drops completed writes from the
+         * front of the queue.
+         */
+        void reap() {
+            io_uring_cqe cqe = ring_->wait();
+            request& r = requests_[cqe.user_data - first_];
+            if (cqe.res < 0) {
+                fail(-cqe.res);
+            } else {
+                for (std::size_t n = cqe.res; n != r.size; ) {
+                    ssize_t m = pwrite(STDOUT_FILENO, r.data + n, r.size - n, r.offset + n);
+                    if (m < 0 && errno != EINTR) {
+                        fail(errno);
+                        break;
+                    }
+                    n += m < 0 ? 0 : m;
+                }
+            }
+            r.done = true;
+            while (!requests_.empty() && requests_.front().done) {
+                requests_.pop_front();
+                ++first_;
+            }
+        }
+
+        void drain() {
+            while (!requests_.empty()) {
+                reap();
+            }
+        }
+
+        void fail(int error) {
+            if (error_ == 0) {
+                error_ = error;
+            }
+        }
+
+        void check() const {
+            if (error_ != 0) {
+                throw std::runtime_error(std::strerror(error_));
+            }
+        }
+
+        io_ring* ring_;
+        std::deque<request> requests_;
+        unsigned long long offset_;
+        unsigned long long first_;
+        int error_;
+#endif
+
+        std::streambuf* sb_;
+        io_backend backend_;
+    };
+
+    /*
+     * A ring of buffers of size characters, each aligned to align
+     * characters and not sharing memory with the others.  get()
+     * returns the least recently used buffer if at least retained
+     * characters have been written after it, counting whole
+     * multiples of align for each buffer, and a new one otherwise.
+     * put() records the end of the characters written to the
+     * buffer returned by the last call to get(), and written() that
+     * these characters have been written.
+     */
+    class buffer_ring {
+    public:
+        buffer_ring(std::size_t size, std::size_t align)
+        : size_(size), align_(align), next_(segments_.end()), last_(segments_.end()) { }
+
+        char* get(std::size_t retained) {
+            std::size_t units = (retained + align_ - 1) / align_;
+            std::size_t after = 0;
+            for (iterator i = segments_.begin(); i != segments_.end(); ++i) {
+                if (i != next_ && i->written) {
+                    after += i->units;
+                }
+            }
+
+            iterator i = next_;
+            if (i != segments_.end() && (i->units == 0 || (i->written && after >= units))) {
+                if (++next_ == segments_.end()) {
+                    next_ = segments_.begin();
+                }
+            } else {
+                // insert a new buffer as the most recently used one
+                i = segments_.insert(next_, segment());
+                i->mem.resize(size_ + align_);
+                std::size_t offset = reinterpret_cast<std::size_t>(&i->mem[0]) % align_;
+                i->data = &i->mem[0] + (align_ - offset) % align_;
+                if (next_ == segments_.end()) {
+                    next_ = segments_.begin();
+                }
+            }
+            i->units = 0;
+            i->written = false;
+            current_ = i;
+            return i->data;
+        }
+
+        void put(const char* end) {
+            current_->units = (end - current_->data + align_ - 1) / align_;
+            last_ = current_;
+        }
+
+        void written() {
+            if (last_ != segments_.end()) {
+                last_->written = true;
+            }
+        }
+
+    private:
+        struct segment {
+            std::vector<char> mem;
+            char* data;
+            std::size_t units;
+            bool written;
+        };
+
+        typedef std::list<segment>::iterator iterator;
+
+        buffer_ring(const buffer_ring&);
+        buffer_ring& operator=(const buffer_ring&);
+
+        std::size_t size_;
+        std::size_t align_;
+        std::list<segment> segments_;
+        iterator next_;
+        iterator current_;
+        iterator last_;
+    };
+
+    class read_task {
+    public:
+        read_task(input_reader& in, char* s, std::size_t n, std::size_t& size)
+        : in_(in), s_(s), n_(n), size_(size) { }
+
+        void operator()() {
+            size_ = in_.read(s_, n_);
+        }
+
+    private:
+        input_reader& in_;
+        char* s_;
+        std::size_t n_;
+        std::size_t& size_;
+    };
+
+    template<class Writer>
+    class write_task {
+    public:
+        write_task(Writer& out, const char* first, const char* last)
+        : out_(out), first_(first), last_(last) { }
+
+        void operator()() {
+            out_.write(first_, last_);
+        }
+
+    private:
+        Writer& out_;
+        const char* first_;
+        const char* last_;
+    };
+
+    /*
+     * Runs a task on a thread of its own if requested and threads
+     * are available, or right away otherwise.  join() rethrows any
+     * exception thrown by the task; the destructor waits for the
+     * task to finish.
+     */
+    class background {
+    public:
+        template<class Task>
+        background(Task task, bool concurrent) {
+#if defined(STLENCODERS_THREADS)
+            if (concurrent) {
+                thread_ = std::thread(run<Task>, task, &error_);
+                return;
+            }
+#else
+            static_cast<void>(concurrent);
+#endif
+            task();
+        }
+
+        ~background() {
+#if defined(STLENCODERS_THREADS)
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+#endif
+        }
+
+        void join() {
+#if defined(STLENCODERS_THREADS)
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+#endif
+        }
+
+    private:
+        background(const background&);
+        background& operator=(const background&);
+
+#if defined(STLENCODERS_THREADS)
+        template<class Task>
+        static void run(Task task, std::exception_ptr* error) {
+            try {
+                task();
+            } catch (...) {
+                *error = std::current_exception();
+            }
+        }
+
+        std::thread thread_;
+        std::exception_ptr error_;
+#endif
+    };
+
+    /*
+     * Passes the input through f in blocks of size characters,
+     * writing the results to out.  f(first, last, result)
+     * transforms a block and f.finish(result) the input held back
+     * at the end into a buffer of buf; neither writes more than the
+     * size of a buffer.  out.sync() is called before returning, so
+     * buf may be released.  If concurrent is true and threads are
+     * available, the next block is read and the output of the
+     * previous one is written while f works on the current one, so
+     * memory use is bounded by two input buffers and buf.
+     */
+    template<class Function, class Writer>
+    void run_pipeline(
+        input_reader& in, Writer& out, Function& f,
+        std::size_t size, buffer_ring& buf, bool concurrent
+        )
+    {
+        std::vector<char> block[2];
+        for (int i = 0; i != 2; ++i) {
+            block[i].resize(size);
+        }
+
+        try {
+            std::size_t n = in.read(&block[0][0], size);
+            const char* prev = 0;
+            const char* end = 0;
+            int cur = 0;
+            while (n != 0) {
+                std::size_t next = 0;
+                char* p = buf.get(out.retained());
+                background reader(read_task(in, &block[cur ^ 1][0], n == size ? size : 0, next), concurrent);
+                background writer(write_task<Writer>(out, prev, end), concurrent);
+                char* result = f(&block[cur][0], &block[cur][0] + n, p);
+                reader.join();
+                writer.join();
+                buf.written();
+                buf.put(result);
+                prev = p;
+                end = result;
+                cur ^= 1;
+                n = next;
+            }
+            out.write(prev, end);
+            buf.written();
+            char* p = buf.get(out.retained());
+            out.write(p, f.finish(p));
+        } catch (...) {
+            // the kernel may still refer to buf
+            try {
+                out.sync();
+            } catch (std::exception&) { }
+            throw;
+        }
+        out.sync();
+    }
+}
+
+#endif
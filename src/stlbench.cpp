@@ -26,11 +26,13 @@
 #include "base16.hpp"
 #include "base32.hpp"
 #include "base64.hpp"
+#include "dispatch.hpp"
 #include "error.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
@@ -419,6 +421,7 @@ void usage(std::ostream& os, const char* progname)
        << "  -a         include alternative implementations\n"
        << "  -l         list supported encoding schemes\n"
        << "  -n NRUNS   number of iterations per test (default 256)\n"
+       << "  -s LEVEL   limit SIMD level to 'scalar', 'ssse3', 'avx2' or 'avx512'\n"
        << "  -w         include wide character encodings\n";
 }
 
@@ -442,7 +445,7 @@ int main(int argc, char* argv[])
     bool wchar = false;
     unsigned long nruns = 256;
 
-    for (int c; (c = getopt(argc, argv, ":aln:w")) != -1; ) {
+    for (int c; (c = getopt(argc, argv, ":aln:s:w")) != -1; ) {
         switch (c) {
         case 'a':
             all = true;
@@ -456,6 +459,21 @@ int main(int argc, char* argv[])
             nruns = std::strtoul(optarg, 0, 0);
             break;
 
+        case 's':
+            if (std::strcmp(optarg, "scalar") == 0) {
+                stlencoders::set_simd_level(stlencoders::simd_scalar);
+            } else if (std::strcmp(optarg, "ssse3") == 0) {
+                stlencoders::set_simd_level(stlencoders::simd_ssse3);
+            } else if (std::strcmp(optarg, "avx2") == 0) {
+                stlencoders::set_simd_level(stlencoders::simd_avx2);
+            } else if (std::strcmp(optarg, "avx512") == 0) {
+                stlencoders::set_simd_level(stlencoders::simd_avx512);
+            } else {
+                usage(std::cout, argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+
         case 'w':
             wchar = true;
             break;
@@ -26,12 +26,15 @@
 #include "base16.hpp"
 #include "base32.hpp"
 #include "base64.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <iostream>
-#include <locale>
+#include <stdexcept>
 #include <string>
 
 #ifdef HAVE_CONFIG_H
@@ -46,6 +49,8 @@
 # include "getopt.hpp"
 #endif
 
+#include "pipeline.hpp"
+
 template<bool F>
 struct predicate {
     template<class T>
@@ -54,64 +59,69 @@ struct predicate {
     }
 };
 
-class skipws {
+// size of the blocks read from the input file
+const std::size_t block_size = 1 << 18;
+
+// size of the blocks read per thread when decoding concurrently
+const std::size_t job_size = 1 << 20;
+
+/*
+ * Adapts a chunk decoder to run_pipeline().
+ */
+template<class Decoder, class Predicate>
+class decode_function {
 public:
-    template<class charT>
-    bool operator()(const charT& c) {
-        return std::isspace(c, loc);
+    decode_function(Predicate skip, std::size_t jobs)
+    : skip_(skip), policy_(jobs, block_size) { }
+
+    char* operator()(const char* first, const char* last, char* result) {
+        return decoder_.update(policy_, first, last, result, skip_);
+    }
+
+    char* finish(char* result) {
+        return decoder_.finish(result);
     }
 
 private:
-    std::locale loc;
+    Decoder decoder_;
+    Predicate skip_;
+    stlencoders::parallel_policy policy_;
 };
 
-template<class Codec, class OutputIterator, class Predicate>
-OutputIterator decode(std::istream& is, OutputIterator out, Predicate skip)
-{
-    std::istreambuf_iterator<char> in(is);
-    std::istreambuf_iterator<char> end;
-    return Codec::decode(in, end, out, skip);
-}
-
-template<class Codec, class OutputIterator, class Predicate>
-OutputIterator fdecode(const char* filename, OutputIterator out,
-                       Predicate skip)
+template<class Codec, class Predicate>
+void decode(input_reader& in, output_writer& out, Predicate skip,
+            std::size_t jobs)
 {
-    if (std::strcmp(filename, "-") == 0) {
-        return decode<Codec>(std::cin, out, skip);
-    }
-
-    std::ifstream is(filename);
-    if (!is) {
-        throw std::runtime_error("cannot open file");
-    }
-    return decode<Codec>(is, out, skip);
+    std::size_t size = jobs == 1 ? block_size : jobs * job_size;
+    decode_function<typename Codec::decoder, Predicate> f(skip, jobs);
+    buffer_ring buf(Codec::max_decode_size(size) + 8, out.alignment());
+    run_pipeline(in, out, f, size, buf, jobs != 1);
 }
 
-template<class OutputIterator, class Predicate>
-OutputIterator decode(const std::string& codec, const char* filename,
-                      OutputIterator out, Predicate skip)
+template<class Predicate>
+void decode(const std::string& codec, input_reader& in, output_writer& out,
+            Predicate skip, std::size_t jobs)
 {
     using namespace stlencoders;
 
     if (codec == "base2") {
         typedef base2_traits<char> traits;
-        return fdecode<base2<char, traits> >(filename, out, skip);
+        return decode<base2<char, traits> >(in, out, skip, jobs);
     } else if (codec == "base16") {
         typedef base16_traits<char> traits;
-        return fdecode<base16<char, traits> >(filename, out, skip);
+        return decode<base16<char, traits> >(in, out, skip, jobs);
     } else if (codec == "base32") {
         typedef base32_traits<char> traits;
-        return fdecode<base32<char, traits> >(filename, out, skip);
+        return decode<base32<char, traits> >(in, out, skip, jobs);
     } else if (codec == "base32hex") {
         typedef base32hex_traits<char> traits;
-        return fdecode<base32<char, traits> >(filename, out, skip);
+        return decode<base32<char, traits> >(in, out, skip, jobs);
     } else if (codec == "base64") {
         typedef base64_traits<char> traits;
-        return fdecode<base64<char, traits> >(filename, out, skip);
+        return decode<base64<char, traits> >(in, out, skip, jobs);
     } else if (codec == "base64url") {
         typedef base64url_traits<char> traits;
-        return fdecode<base64<char, traits> >(filename, out, skip);
+        return decode<base64<char, traits> >(in, out, skip, jobs);
     } else {
         throw std::runtime_error("unknown encoding: '" + codec + "'");
     }
@@ -122,8 +132,16 @@ void usage(std::ostream& os, const char* progname)
     os << "Usage: " << progname << " [OPTION]... [FILE]\n"
        << "Decode FILE, or standard input, to standard output.\n"
        << "\n"
+       << "  -b NAME    I/O backend: 'auto' (default), 'write', 'splice' or\n"
+       << "             'uring'; 'auto' uses 'uring' if standard output is a\n"
+       << "             regular file, and 'write' otherwise; 'splice' requires\n"
+       << "             standard output to be a pipe whose reader copies the\n"
+       << "             data, and must not be used if the reader moves it on\n"
+       << "             with splice(2) or tee(2)\n"
        << "  -c NAME    input encoding (default 'base64')\n"
        << "  -i         ignore non-alphabet characters\n"
+       << "  -j JOBS    decode with JOBS threads (default 1), at most twice\n"
+       << "             the number of hardware threads\n"
        << "  -l         list supported encoding schemes\n"
        << "  -s         do not skip whitespace in input\n"
        << "\n"
@@ -132,12 +150,18 @@ void usage(std::ostream& os, const char* progname)
 
 int main(int argc, char* argv[])
 {
+    std::string backend = "auto";
     std::string codec = "base64";
     bool skipall = false;
     bool noskip = false;
+    unsigned long jobs = 1;
 
-    for (int c; (c = getopt(argc, argv, ":c:ils")) != -1; ) {
+    for (int c; (c = getopt(argc, argv, ":b:c:ij:ls")) != -1; ) {
         switch (c) {
+        case 'b':
+            backend = optarg;
+            break;
+
         case 'c':
             codec = optarg;
             break;
@@ -146,6 +170,11 @@ int main(int argc, char* argv[])
             skipall = true;
             break;
 
+        case 'j':
+            jobs = std::max(std::strtoul(optarg, 0, 0), 1ul);
+            jobs = std::min<unsigned long>(jobs, max_jobs());
+            break;
+
         case 'l':
             std::cout << "base2 base16 base32 base32hex base64 base64url\n";
             return EXIT_SUCCESS;
@@ -162,16 +191,21 @@ int main(int argc, char* argv[])
 
     const char* filename = optind != argc ? argv[optind] : "-";
 
+    std::ios::sync_with_stdio(false);
+
     try {
-        std::ostreambuf_iterator<char> out(std::cout);
+        output_writer out(std::cout.rdbuf(), parse_backend(backend));
+        input_reader in(filename, out.backend());
 
         if (noskip) {
-            decode(codec, filename, out, predicate<false>());
+            decode(codec, in, out, predicate<false>(), jobs);
         } else if (skipall) {
-            decode(codec, filename, out, predicate<true>());
+            decode(codec, in, out, predicate<true>(), jobs);
         } else {
-            decode(codec, filename, out, skipws());
+            decode(codec, in, out, stlencoders::ascii_whitespace(), jobs);
         }
+
+        out.finish();
     } catch (std::exception& e) {
         std::cerr << argv[0] << ": " << filename << ": " << e.what() << '\n';
         return EXIT_FAILURE;
@@ -26,15 +26,18 @@
 #include "base16.hpp"
 #include "base32.hpp"
 #include "base64.hpp"
-#include "iterator.hpp"
+#include "parallel.hpp"
 #include "traits.hpp"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
-#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #ifdef HAVE_CONFIG_H
 # include "config.h"
@@ -48,74 +51,176 @@
 # include "getopt.hpp"
 #endif
 
-template<class Codec, class OutputIterator>
-OutputIterator encode(std::istream& is, OutputIterator out)
-{
-    std::istreambuf_iterator<char> in(is);
-    std::istreambuf_iterator<char> end;
-    return Codec::encode(in, end, out);
-}
+#include "pipeline.hpp"
 
-template<class Codec, class OutputIterator>
-OutputIterator encode(std::istream& is, OutputIterator out, bool pad)
-{
-    std::istreambuf_iterator<char> in(is);
-    std::istreambuf_iterator<char> end;
-    return Codec::encode(in, end, out, pad);
-}
+// size of the blocks read from the input file
+const std::size_t block_size = 1 << 18;
 
-template<class Codec, class OutputIterator>
-OutputIterator fencode(const char* filename, OutputIterator out)
-{
-    if (!filename || std::strcmp(filename, "-") == 0) {
-        return encode<Codec>(std::cin, out);
+// size of the blocks read per thread when encoding concurrently
+const std::size_t job_size = 1 << 20;
+
+/*
+ * Writes encoded characters in large blocks, inserting a line break
+ * after every cols characters.  Blocks are collected in a ring of
+ * buffers long enough that none is modified while the output still
+ * refers to it.  If cols is 0, characters are passed on as they are,
+ * and the caller must not modify them before retained() more
+ * characters have been written.
+ */
+class block_writer {
+public:
+    block_writer(output_writer& out, std::size_t cols, const char* endl)
+    : out_(out), cols_(cols), pos_(0), endl_(endl), size_(std::strlen(endl)),
+      buf_(segment_size, out.alignment()), data_(0), end_(0) { }
+
+    ~block_writer() {
+        // the kernel may still refer to buf_
+        try {
+            out_.sync();
+        } catch (std::exception&) { }
+    }
+
+    void write(const char* first, const char* last) {
+        if (cols_ == 0) {
+            return out_.write(first, last);
+        }
+        while (first != last) {
+            if (pos_ == cols_) {
+                put(endl_, endl_ + size_);
+                pos_ = 0;
+            }
+            std::size_t n = std::min(std::size_t(last - first), cols_ - pos_);
+            put(first, first + n);
+            pos_ += n;
+            first += n;
+        }
     }
 
-    std::ifstream is(filename);
-    if (!is) {
-        throw std::runtime_error("cannot open file");
+    void finish() {
+        if (cols_ != 0) {
+            put(endl_, endl_ + size_);
+            out_.write(data_, data_ + end_);
+        }
     }
-    return encode<Codec>(is, out);
-}
 
-template<class Codec, class OutputIterator>
-OutputIterator fencode(const char* filename, OutputIterator out, bool pad)
-{
-    if (!filename || std::strcmp(filename, "-") == 0) {
-        return encode<Codec>(std::cin, out, pad);
+    /*
+     * Waits until the characters passed to write() may be modified.
+     */
+    void sync() {
+        if (cols_ == 0) {
+            out_.sync();
+        }
+    }
+
+    /*
+     * Returns the number of characters that must be written after
+     * those passed to write() before they may be modified.
+     */
+    std::size_t retained() const {
+        return cols_ == 0 ? out_.retained() : 0;
+    }
+
+    /*
+     * Returns the alignment of buffers passed to write() that do not
+     * share pages with others.
+     */
+    std::size_t alignment() const {
+        return cols_ == 0 ? out_.alignment() : 1;
+    }
+
+private:
+    static const std::size_t segment_size = block_size * 2;
+
+    void put(const char* first, const char* last) {
+        while (first != last) {
+            if (!data_ || end_ == segment_size) {
+                if (data_) {
+                    out_.write(data_, data_ + end_);
+                    buf_.put(data_ + end_);
+                    buf_.written();
+                }
+                data_ = buf_.get(out_.retained());
+                end_ = 0;
+            }
+            std::size_t n = std::min(std::size_t(last - first), segment_size - end_);
+            std::memcpy(data_ + end_, first, n);
+            end_ += n;
+            first += n;
+        }
+    }
+
+    output_writer& out_;
+    std::size_t cols_;
+    std::size_t pos_;
+    const char* endl_;
+    std::size_t size_;
+    buffer_ring buf_;
+    char* data_;
+    std::size_t end_;
+};
+
+/*
+ * Adapts a chunk encoder to run_pipeline().
+ */
+template<class Encoder>
+class encode_function {
+public:
+    encode_function(Encoder encoder, std::size_t jobs)
+    : encoder_(encoder), policy_(jobs, block_size) { }
+
+    char* operator()(const char* first, const char* last, char* result) {
+        return encoder_.update(policy_, first, last, result);
     }
 
-    std::ifstream is(filename);
-    if (!is) {
-        throw std::runtime_error("cannot open file");
+    char* finish(char* result) {
+        return encoder_.finish(result);
     }
-    return encode<Codec>(is, out, pad);
+
+private:
+    Encoder encoder_;
+    stlencoders::parallel_policy policy_;
+};
+
+template<class Codec, class Encoder>
+void encode(input_reader& in, block_writer& out, Encoder encoder,
+            std::size_t jobs)
+{
+    std::size_t size = jobs == 1 ? block_size : jobs * job_size;
+    encode_function<Encoder> f(encoder, jobs);
+    buffer_ring buf(Codec::max_encode_size(size) + 16, out.alignment());
+    run_pipeline(in, out, f, size, buf, jobs != 1);
 }
 
-template<template<class T> class encoding_traits, class OutputIterator>
-OutputIterator encode(const std::string& codec, const char* filename,
-                      OutputIterator out, bool pad)
+template<template<class T> class encoding_traits>
+void encode(const std::string& codec, input_reader& in,
+            block_writer& out, bool pad, std::size_t jobs)
 {
     using namespace stlencoders;
 
     if (codec == "base2") {
         typedef base2_traits<char> traits;
-        return fencode<base2<char, traits> >(filename, out);
+        typedef base2<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(), jobs);
     } else if (codec == "base16") {
         typedef encoding_traits<base16_traits<char> > traits;
-        return fencode<base16<char, traits> >(filename, out);
+        typedef base16<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(), jobs);
     } else if (codec == "base32") {
         typedef encoding_traits<base32_traits<char> > traits;
-        return fencode<base32<char, traits> >(filename, out, pad);
+        typedef base32<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(pad), jobs);
     } else if (codec == "base32hex") {
         typedef encoding_traits<base32hex_traits<char> > traits;
-        return fencode<base32<char, traits> >(filename, out, pad);
+        typedef base32<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(pad), jobs);
     } else if (codec == "base64") {
         typedef base64_traits<char> traits;
-        return fencode<base64<char, traits> >(filename, out, pad);
+        typedef base64<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(pad), jobs);
     } else if (codec == "base64url") {
         typedef base64url_traits<char> traits;
-        return fencode<base64<char, traits> >(filename, out, pad);
+        typedef base64<char, traits> codec_type;
+        return encode<codec_type>(in, out, typename codec_type::encoder(pad), jobs);
     } else {
         throw std::runtime_error("unknown encoding: '" + codec + "'");
     }
@@ -126,7 +231,15 @@ void usage(std::ostream& os, const char* progname)
     os << "Usage: " << progname << " [OPTION]... [FILE]\n"
        << "Encode FILE, or standard input, to standard output.\n"
        << "\n"
+       << "  -b NAME    I/O backend: 'auto' (default), 'write', 'splice' or\n"
+       << "             'uring'; 'auto' uses 'uring' if standard output is a\n"
+       << "             regular file, and 'write' otherwise; 'splice' requires\n"
+       << "             standard output to be a pipe whose reader copies the\n"
+       << "             data, and must not be used if the reader moves it on\n"
+       << "             with splice(2) or tee(2)\n"
        << "  -c NAME    output encoding (default 'base64')\n"
+       << "  -j JOBS    encode with JOBS threads (default 1), at most twice\n"
+       << "             the number of hardware threads\n"
        << "  -l         list supported encoding schemes\n"
        << "  -m         use MIME line breaks (CRLF)\n"
        << "  -n         no padding at the end of encoded data\n"
@@ -139,18 +252,29 @@ void usage(std::ostream& os, const char* progname)
 
 int main(int argc, char* argv[])
 {
+    std::string backend = "auto";
     std::string codec = "base64";
     unsigned long wrap = 76;
     const char* endl = "\n";
     bool uppercase = false;
     bool padding = true;
+    unsigned long jobs = 1;
 
-    for (int c; (c = getopt(argc, argv, ":c:lmnuw:")) != -1; ) {
+    for (int c; (c = getopt(argc, argv, ":b:c:j:lmnuw:")) != -1; ) {
         switch (c) {
+        case 'b':
+            backend = optarg;
+            break;
+
         case 'c':
             codec = optarg;
             break;
 
+        case 'j':
+            jobs = std::max(std::strtoul(optarg, 0, 0), 1ul);
+            jobs = std::min<unsigned long>(jobs, max_jobs());
+            break;
+
         case 'l':
             std::cout << "base2 base16 base32 base32hex base64 base64url\n";
             return EXIT_SUCCESS;
@@ -179,24 +303,23 @@ int main(int argc, char* argv[])
 
     const char* filename = optind != argc ? argv[optind] : "-";
 
-    std::ostreambuf_iterator<char> out(std::cout);
+    std::ios::sync_with_stdio(false);
 
     try {
         using namespace stlencoders;
 
+        output_writer writer(std::cout.rdbuf(), parse_backend(backend));
+        input_reader in(filename, writer.backend());
+        block_writer out(writer, wrap, endl);
+
         if (uppercase) {
-            encode<upper_char_encoding_traits>(
-                codec, filename, line_wrapper(out, wrap, endl), padding
-                );
+            encode<upper_char_encoding_traits>(codec, in, out, padding, jobs);
         } else {
-            encode<lower_char_encoding_traits>(
-                codec, filename, line_wrapper(out, wrap, endl), padding
-                );
+            encode<lower_char_encoding_traits>(codec, in, out, padding, jobs);
         }
 
-        if (wrap != 0) {
-            std::cout << endl;
-        }
+        out.finish();
+        writer.finish();
     } catch (std::exception& e) {
         std::cerr << argv[0] << ": " << filename << ": " << e.what() << '\n';
         return EXIT_FAILURE;
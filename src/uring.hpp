@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef URING_HPP
+#define URING_HPP
+
+#if defined(HAVE_IO_URING)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    /*
+     * A minimal io_uring(7) instance, set up with the raw system
+     * calls so that no library is needed.  Requests are submitted
+     * one at a time by a single thread, which also reaps their
+     * completions.
+     */
+    class io_ring {
+    public:
+        explicit io_ring(unsigned entries) : sq_(MAP_FAILED), cq_(MAP_FAILED), sqes_(MAP_FAILED)
+        {
+            io_uring_params p;
+            std::memset(&p, 0, sizeof p);
+            fd_ = syscall(__NR_io_uring_setup, entries, &p);
+            if (fd_ < 0) {
+                throw std::runtime_error(std::strerror(errno));
+            }
+            entries_ = p.sq_entries;
+
+            sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            if (p.features & IORING_FEAT_SINGLE_MMAP) {
+                sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+            }
+            sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+
+            sq_ = map(sq_size_, IORING_OFF_SQ_RING);
+            cq_ = p.features & IORING_FEAT_SINGLE_MMAP ? sq_ : map(cq_size_, IORING_OFF_CQ_RING);
+            sqes_ = map(sqes_size_, IORING_OFF_SQES);
+            if (sq_ == MAP_FAILED || cq_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+                int error = errno;
+                close();
+                throw std::runtime_error(std::strerror(error));
+            }
+
+            char* sq = static_cast<char*>(sq_);
+            sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+            sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+            sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+            char* cq = static_cast<char*>(cq_);
+            cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+            cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+            cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+            cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        }
+
+        ~io_ring() {
+            close();
+        }
+
+        /*
+         * Returns the number of requests that may be in flight.
+         */
+        std::size_t entries() const {
+            return entries_;
+        }
+
+        /*
+         * Submits a read or write request for len bytes at offset of
+         * the file fd, to be completed with user_data.
+         */
+        void submit(int opcode, int fd, const void* buf, std::size_t len,
+                    unsigned long long offset, unsigned long long user_data)
+        {
+            unsigned tail = *sq_tail_;
+            unsigned index = tail & sq_mask_;
+            io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+            std::memset(sqe, 0, sizeof *sqe);
+            sqe->opcode = opcode;
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<unsigned long>(buf);
+            sqe->len = len;
+            sqe->off = offset;
+            sqe->user_data = user_data;
+            sq_array_[index] = index;
+            __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+            while (syscall(__NR_io_uring_enter, fd_, 1, 0, 0, 0, 0) < 0) {
+                if (errno != EINTR) {
+                    throw std::runtime_error(std::strerror(errno));
+                }
+            }
+        }
+
+        /*
+         * Waits for the next completion.
+         */
+        io_uring_cqe wait() {
+            unsigned head = *cq_head_;
+            while (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                if (syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, 0, 0) < 0 && errno != EINTR) {
+                    throw std::runtime_error(std::strerror(errno));
+                }
+            }
+            io_uring_cqe cqe = cqes_[head & cq_mask_];
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            return cqe;
+        }
+
+    private:
+        io_ring(const io_ring&);
+        io_ring& operator=(const io_ring&);
+
+        void* map(std::size_t size, off_t offset) {
+            return mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        }
+
+        void close() {
+            if (sqes_ != MAP_FAILED) {
+                munmap(sqes_, sqes_size_);
+            }
+            if (cq_ != MAP_FAILED && cq_ != sq_) {
+                munmap(cq_, cq_size_);
+            }
+            if (sq_ != MAP_FAILED) {
+                munmap(sq_, sq_size_);
+            }
+            ::close(fd_);
+        }
+
+        int fd_;
+        std::size_t entries_;
+        void* sq_;
+        void* cq_;
+        void* sqes_;
+        std::size_t sq_size_;
+        std::size_t cq_size_;
+        std::size_t sqes_size_;
+        unsigned* sq_tail_;
+        unsigned sq_mask_;
+        unsigned* sq_array_;
+        unsigned* cq_head_;
+        unsigned* cq_tail_;
+        unsigned cq_mask_;
+        io_uring_cqe* cqes_;
+    };
+}
+
+#endif
+
+#endif
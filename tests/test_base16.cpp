@@ -23,13 +23,100 @@
  */
 
 #include "base16.hpp"
+#include "dispatch.hpp"
 #include "util.hpp"
 
 #include <cassert>
 #include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <list>
 #include <locale>
 #include <string>
 
+static void test_base16_blocks()
+{
+    typedef stlencoders::base16<char> base16;
+    typedef stlencoders::base16<wchar_t> wbase16;
+
+    // test contiguous ranges spanning multiple blocks
+
+    for (std::size_t n = 0; n != 256; ++n) {
+        std::string s = randstr(n);
+
+        assert(strenc<base16>(s) == seqenc<base16>(s));
+        assert(ptrenc<base16>(s) == seqenc<base16>(s));
+        assert(strenc<wbase16>(s) == seqenc<wbase16>(s));
+
+        std::deque<char> d(s.begin(), s.end());
+        std::string t;
+        base16::encode(d.begin(), d.end(), std::back_inserter(t));
+        assert(t == seqenc<base16>(s));
+
+        std::list<char> l(s.begin(), s.end());
+        std::string lower(base16::max_encode_size(s.size()), '\0');
+        lower.resize(base16::encode_lower(s.begin(), s.end(), lower.begin()) - lower.begin());
+        std::string lseq;
+        base16::encode_lower(l.begin(), l.end(), std::back_inserter(lseq));
+        assert(lower == lseq);
+        for (std::size_t i = 0; i != lower.size(); ++i) {
+            assert(lower[i] == std::tolower(seqenc<base16>(s)[i], std::locale::classic()));
+        }
+
+        std::string upper(base16::max_encode_size(s.size()), '\0');
+        upper.resize(base16::encode_upper(s.begin(), s.end(), upper.begin()) - upper.begin());
+        assert(upper == seqenc<base16>(s));
+
+        // mix cases within blocks
+        std::string mixed = upper;
+        for (std::size_t i = 0; i < mixed.size(); i += 3) {
+            mixed[i] = lower[i];
+        }
+
+        assert(strdec<base16>(seqenc<base16>(s)) == s);
+        assert(ptrdec<base16>(seqenc<base16>(s)) == s);
+        assert(ptrdec<base16>(lower) == s);
+        assert(ptrdec<base16>(mixed) == s);
+    }
+
+    // test invalid characters inside blocks
+
+    for (std::size_t n = 0; n != 160; ++n) {
+        std::string s = strenc<base16>(randstr(80));
+
+        std::string t = s;
+        t[n] = '?';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = '/';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = ':';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = '@';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = 'G';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = '`';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = 'g';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = '\x10';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+        t[n] = '\xc1';
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_character);
+
+        t = s;
+        t.insert(n, 1, ' ');
+        assert(ptrdec<base16>(t, make_skip(" ")) == seqdec<base16>(t, make_skip(" ")));
+        t = s;
+        t.erase(n, 1);
+        assert_throw(ptrdec<base16>(t), stlencoders::invalid_length);
+    }
+
+    assert(ptrenc<base16>(std::string(64, '\xff')) == std::string(128, 'F'));
+    assert(ptrdec<base16>(std::string(128, 'f')) == std::string(64, '\xff'));
+    assert(ptrdec<base16>(std::string(128, 'F')) == std::string(64, '\xff'));
+}
+
 void test_base16()
 {
     typedef stlencoders::base16<char> base16;
@@ -145,6 +232,9 @@ void test_base16()
         assert(traits::eq_int_type(traits::to_int_type(lc), traits::to_int_type(uc)));
     }
 
+    // test block kernels for all SIMD levels
+
+    for_each_simd_level(test_base16_blocks);
 }
 
 #ifndef UNITTEST
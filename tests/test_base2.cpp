@@ -23,12 +23,80 @@
  */
 
 #include "base2.hpp"
+#include "dispatch.hpp"
 #include "util.hpp"
 
 #include <cassert>
 #include <cstdlib>
+#include <deque>
+#include <iterator>
 #include <string>
 
+struct base2_dot_traits : public stlencoders::base2_traits<char> {
+    static char_type to_char_type(const int_type& c) {
+        return ".#"[c];
+    }
+
+    static int_type to_int_type(const char_type& c) {
+        return c == '.' ? 0 : c == '#' ? 1 : inv();
+    }
+};
+
+static void test_base2_blocks()
+{
+    typedef stlencoders::base2<char> base2;
+    typedef stlencoders::base2<wchar_t> wbase2;
+    typedef stlencoders::base2<char, base2_dot_traits> base2dot;
+
+    // test contiguous ranges spanning multiple blocks
+
+    for (std::size_t n = 0; n != 256; ++n) {
+        std::string s = randstr(n);
+
+        assert(strenc<base2>(s) == seqenc<base2>(s));
+        assert(ptrenc<base2>(s) == seqenc<base2>(s));
+        assert(strenc<wbase2>(s) == seqenc<wbase2>(s));
+        assert(ptrenc<base2dot>(s) == seqenc<base2dot>(s));
+
+        std::deque<char> d(s.begin(), s.end());
+        std::string t;
+        base2::encode(d.begin(), d.end(), std::back_inserter(t));
+        assert(t == seqenc<base2>(s));
+
+        assert(strdec<base2>(seqenc<base2>(s)) == s);
+        assert(ptrdec<base2>(seqenc<base2>(s)) == s);
+        assert(ptrdec<base2dot>(seqenc<base2dot>(s)) == s);
+    }
+
+    // test invalid characters inside blocks
+
+    for (std::size_t n = 0; n != 192; ++n) {
+        std::string s = strenc<base2>(randstr(24));
+
+        std::string t = s;
+        t[n] = '2';
+        assert_throw(ptrdec<base2>(t), stlencoders::invalid_character);
+        t[n] = '/';
+        assert_throw(ptrdec<base2>(t), stlencoders::invalid_character);
+        t[n] = '\xb1';
+        assert_throw(ptrdec<base2>(t), stlencoders::invalid_character);
+        t[n] = '\x01';
+        assert_throw(ptrdec<base2>(t), stlencoders::invalid_character);
+
+        t = s;
+        t.insert(n, 1, ' ');
+        assert(ptrdec<base2>(t, make_skip(" ")) == seqdec<base2>(t, make_skip(" ")));
+        t = s;
+        t.erase(n, 1);
+        assert_throw(ptrdec<base2>(t), stlencoders::invalid_length);
+    }
+
+    assert(ptrenc<base2>(std::string(16, '\xff')) == std::string(128, '1'));
+    assert(ptrenc<base2>(std::string(16, '\x00')) == std::string(128, '0'));
+    assert(ptrdec<base2>(std::string(128, '1')) == std::string(16, '\xff'));
+    assert(ptrdec<base2>(std::string(128, '0')) == std::string(16, '\x00'));
+}
+
 void test_base2()
 {
     typedef stlencoders::base2<char> base2;
@@ -136,6 +204,10 @@ void test_base2()
     assert_throw(strdec<base2>("000000?00", make_skip("")), stlencoders::invalid_character);
     assert_throw(strdec<base2>("0000000?0", make_skip("")), stlencoders::invalid_character);
     assert_throw(strdec<base2>("00000000?", make_skip("")), stlencoders::invalid_character);
+
+    // test block kernels for all SIMD levels
+
+    for_each_simd_level(test_base2_blocks);
 }
 
 #ifndef UNITTEST
@@ -23,13 +23,105 @@
  */
 
 #include "base32.hpp"
+#include "dispatch.hpp"
 #include "util.hpp"
 
 #include <cassert>
 #include <cstdlib>
+#include <iterator>
+#include <list>
 #include <locale>
 #include <string>
 
+static void test_base32_blocks()
+{
+    typedef stlencoders::base32<char> base32;
+    typedef stlencoders::base32<wchar_t> wbase32;
+    typedef stlencoders::base32<char, stlencoders::base32hex_traits<char> > base32hex;
+
+    // test contiguous ranges spanning multiple blocks
+
+    for (std::size_t n = 0; n != 256; ++n) {
+        std::string s = randstr(n);
+
+        assert(strenc<base32>(s) == seqenc<base32>(s));
+        assert(ptrenc<base32>(s) == seqenc<base32>(s));
+        assert(ptrenc<base32>(s, false) == seqenc<base32>(s, false));
+        assert(ptrenc<base32hex>(s) == seqenc<base32hex>(s));
+        assert(strenc<wbase32>(s) == seqenc<wbase32>(s));
+
+        std::list<char> l(s.begin(), s.end());
+        std::string lower(base32::max_encode_size(s.size()), '\0');
+        lower.resize(base32::encode_lower(s.begin(), s.end(), lower.begin()) - lower.begin());
+        std::string lseq;
+        base32::encode_lower(l.begin(), l.end(), std::back_inserter(lseq));
+        assert(lower == lseq);
+        for (std::size_t i = 0; i != lower.size(); ++i) {
+            assert(lower[i] == std::tolower(seqenc<base32>(s)[i], std::locale::classic()));
+        }
+
+        std::string hexlower(base32hex::max_encode_size(s.size()), '\0');
+        hexlower.resize(base32hex::encode_lower(s.begin(), s.end(), hexlower.begin()) - hexlower.begin());
+        std::string hexupper(base32hex::max_encode_size(s.size()), '\0');
+        hexupper.resize(base32hex::encode_upper(s.begin(), s.end(), hexupper.begin()) - hexupper.begin());
+        assert(hexupper == seqenc<base32hex>(s));
+        for (std::size_t i = 0; i != hexlower.size(); ++i) {
+            assert(hexlower[i] == std::tolower(hexupper[i], std::locale::classic()));
+        }
+
+        assert(strdec<base32>(seqenc<base32>(s)) == s);
+        assert(ptrdec<base32>(seqenc<base32>(s, false)) == s);
+        assert(ptrdec<base32>(lower) == s);
+        assert(ptrdec<base32hex>(seqenc<base32hex>(s)) == s);
+        assert(ptrdec<base32hex>(hexlower) == s);
+    }
+
+    // test invalid characters and padding inside blocks
+
+    for (std::size_t n = 0; n != 96; ++n) {
+        std::string s = strenc<base32>(randstr(60));
+
+        std::string t = s;
+        t[n] = '?';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '1';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '8';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '@';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '[';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '{';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = '\x80';
+        assert_throw(ptrdec<base32>(t), stlencoders::invalid_character);
+        t[n] = ' ';
+        assert(ptrdec<base32>(t, make_skip(" ")) == seqdec<base32>(t, make_skip(" ")));
+        t[n] = '=';
+        if (n % 8 == 1 || n % 8 == 3 || n % 8 == 6) {
+            assert_throw(ptrdec<base32>(t), stlencoders::invalid_length);
+        } else {
+            assert(ptrdec<base32>(t) == seqdec<base32>(t));
+        }
+
+        std::string u = strenc<base32hex>(randstr(60));
+        u[n] = 'W';
+        assert_throw(ptrdec<base32hex>(u), stlencoders::invalid_character);
+        u[n] = 'w';
+        assert_throw(ptrdec<base32hex>(u), stlencoders::invalid_character);
+        u[n] = ':';
+        assert_throw(ptrdec<base32hex>(u), stlencoders::invalid_character);
+        u[n] = '@';
+        assert_throw(ptrdec<base32hex>(u), stlencoders::invalid_character);
+    }
+
+    assert(ptrenc<base32>(std::string(40, '\xff')) == std::string(64, '7'));
+    assert(ptrenc<base32hex>(std::string(40, '\xff')) == std::string(64, 'V'));
+    assert(ptrdec<base32>(std::string(64, '7')) == std::string(40, '\xff'));
+    assert(ptrdec<base32hex>(std::string(64, 'v')) == std::string(40, '\xff'));
+}
+
 void test_base32()
 {
     typedef stlencoders::base32<char> base32;
@@ -281,6 +373,10 @@ void test_base32()
         assert(traits::eq(lc, std::tolower(c, std::locale::classic())));
         assert(traits::eq_int_type(traits::to_int_type(lc), traits::to_int_type(uc)));
     }
+
+    // test block kernels for all SIMD levels
+
+    for_each_simd_level(test_base32_blocks);
 }
 
 #ifndef UNITTEST
@@ -23,12 +23,80 @@
  */
 
 #include "base64.hpp"
+#include "dispatch.hpp"
 #include "util.hpp"
 
 #include <cassert>
 #include <cstdlib>
 #include <string>
 
+static void test_base64_blocks()
+{
+    typedef stlencoders::base64<char> base64;
+    typedef stlencoders::base64<char, stlencoders::base64url_traits<char> > base64url;
+    typedef stlencoders::base64<wchar_t> wbase64;
+
+    // test contiguous ranges spanning multiple blocks
+
+    for (std::size_t n = 0; n != 256; ++n) {
+        std::string s = randstr(n);
+
+        assert(strenc<base64>(s) == seqenc<base64>(s));
+        assert(strenc<base64url>(s, false) == seqenc<base64url>(s, false));
+        assert(strdec<base64>(seqenc<base64>(s)) == s);
+
+        assert(ptrenc<base64>(s) == seqenc<base64>(s));
+        assert(ptrenc<base64>(s, false) == seqenc<base64>(s, false));
+        assert(ptrenc<base64url>(s) == seqenc<base64url>(s));
+        assert(ptrenc<base64url>(s, false) == seqenc<base64url>(s, false));
+
+        assert(ptrdec<base64>(strenc<base64>(s)) == s);
+        assert(ptrdec<base64>(strenc<base64>(s, false)) == s);
+        assert(ptrdec<base64url>(strenc<base64url>(s)) == s);
+        assert(ptrdec<base64url>(strenc<base64url>(s, false)) == s);
+
+        assert(ptrenc<wbase64>(s) == seqenc<wbase64>(s));
+        assert(ptrdec<wbase64>(seqenc<wbase64>(s)) == s);
+    }
+
+    // test invalid characters and padding inside blocks
+
+    for (std::size_t n = 0; n != 96; ++n) {
+        std::string s = strenc<base64>(randstr(72));
+
+        std::string t = s;
+        t[n] = '?';
+        assert_throw(ptrdec<base64>(t), stlencoders::invalid_character);
+        t[n] = '-';
+        assert_throw(ptrdec<base64>(t), stlencoders::invalid_character);
+        t[n] = '\x80';
+        assert_throw(ptrdec<base64>(t), stlencoders::invalid_character);
+        t[n] = '=';
+        if (n % 4 != 1) {
+            assert(ptrdec<base64>(t) == seqdec<base64>(t));
+            assert(ptrdec<base64>(t, make_skip(" ")) == seqdec<base64>(t, make_skip(" ")));
+        } else {
+            assert_throw(ptrdec<base64>(t), stlencoders::invalid_length);
+        }
+        t[n] = ' ';
+        assert(ptrdec<base64>(t, make_skip(" ")) == seqdec<base64>(t, make_skip(" ")));
+
+        std::string u = strenc<base64url>(randstr(72));
+        u[n] = '+';
+        assert_throw(ptrdec<base64url>(u), stlencoders::invalid_character);
+        u[n] = '/';
+        assert_throw(ptrdec<base64url>(u), stlencoders::invalid_character);
+    }
+
+    assert_throw(ptrdec<wbase64>(L"\x141AAA"), stlencoders::invalid_character);
+    assert_throw(ptrdec<wbase64>(L"AAAA\x141AAA"), stlencoders::invalid_character);
+    assert_throw(ptrdec<base64>(std::string(33, 'A')), stlencoders::invalid_length);
+    assert_throw(ptrdec<base64>(std::string(65, 'A')), stlencoders::invalid_length);
+
+    assert(ptrenc<base64>(std::string(48, '\xff')) == std::string(64, '/'));
+    assert(ptrenc<base64url>(std::string(48, '\xff')) == std::string(64, '_'));
+}
+
 void test_base64()
 {
     typedef stlencoders::base64<char> base64;
@@ -204,6 +272,10 @@ void test_base64()
     assert_throw(strdec<base64>("AA?AA", make_skip("")), stlencoders::invalid_character);
     assert_throw(strdec<base64>("AAA?A", make_skip("")), stlencoders::invalid_character);
     assert_throw(strdec<base64>("AAAA?", make_skip("")), stlencoders::invalid_character);
+
+    // test block kernels for all SIMD levels
+
+    for_each_simd_level(test_base64_blocks);
 }
 
 #ifndef UNITTEST
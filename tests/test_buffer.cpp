@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_buffer.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "buffer.hpp"
+#include "dispatch.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    /*
+     * Splits n bytes at p into buffers of random size, including
+     * empty ones.
+     */
+    template<class Buffer, class T>
+    std::vector<Buffer> split(T* p, std::size_t n)
+    {
+        std::vector<Buffer> v;
+        for (;;) {
+            std::size_t k = std::rand() % 3 == 0 ? std::rand() % 100 : std::rand() % 8;
+            if (k > n) {
+                k = n;
+            }
+            Buffer b = { p, k };
+            v.push_back(b);
+            if (n == 0) {
+                return v;
+            }
+            p += k;
+            n -= k;
+        }
+    }
+
+    template<class C>
+    void test_codec()
+    {
+        using stlencoders::const_buffer;
+        using stlencoders::mutable_buffer;
+
+        for (std::size_t n = 0; n < 2000; n += 1 + n / 4) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+
+            // each output buffer is allocated separately
+            std::vector<const_buffer> in = split<const_buffer>(s.data(), s.size());
+            std::vector<std::string> chunks;
+            std::vector<mutable_buffer> out;
+            for (std::size_t m = 0; m < e.size(); ) {
+                std::size_t k = std::rand() % 50 + 1;
+                chunks.push_back(std::string(k, '\0'));
+                m += k;
+            }
+            for (std::size_t i = 0; i != chunks.size(); ++i) {
+                mutable_buffer b = { &chunks[i][0], chunks[i].size() };
+                out.push_back(b);
+            }
+
+            stlencoders::codec_result r = C::encodev(&in[0], in.size(), out.empty() ? 0 : &out[0], out.size());
+            assert(r.status == stlencoders::codec_done);
+            assert(r.consumed == n && r.produced == e.size());
+            std::string t;
+            for (std::size_t i = 0; i != chunks.size(); ++i) {
+                t += chunks[i];
+            }
+            assert(t.substr(0, e.size()) == e);
+
+            std::vector<const_buffer> ein = split<const_buffer>(e.data(), e.size());
+            std::vector<char> dst(n + 1);
+            std::vector<mutable_buffer> dout = split<mutable_buffer>(&dst[0], n);
+            r = C::decodev(&ein[0], ein.size(), &dout[0], dout.size());
+            assert(r.status == stlencoders::codec_done);
+            assert(r.consumed == e.size() && r.produced == n);
+            assert(std::string(&dst[0], n) == s);
+
+            if (n != 0) {
+                // output too small by one byte
+                dout = split<mutable_buffer>(&dst[0], n - 1);
+                r = C::decodev(&ein[0], ein.size(), &dout[0], dout.size());
+                assert(r.status == stlencoders::codec_output_full);
+                assert(r.produced == n - 1);
+            }
+        }
+    }
+
+    void test_skip()
+    {
+        using namespace stlencoders;
+
+        std::string s = randstr(10000);
+        std::string e = seqenc<base64<char> >(s);
+        std::string w;
+        for (std::size_t i = 0; i < e.size(); i += 76) {
+            w += e.substr(i, 76) + "\r\n";
+        }
+
+        std::vector<const_buffer> in = split<const_buffer>(w.data(), w.size());
+        std::vector<char> dst(s.size());
+        std::vector<mutable_buffer> out = split<mutable_buffer>(&dst[0], dst.size());
+
+        codec_result r = base64<char>::decodev(&in[0], in.size(), &out[0], out.size(), ascii_whitespace());
+        assert(r.status == codec_done && r.produced == s.size());
+        assert(std::string(&dst[0], dst.size()) == s);
+
+        w[5000] = '?';
+        r = base64<char>::decodev(&in[0], in.size(), &out[0], out.size(), ascii_whitespace());
+        assert(r.status == codec_error && r.consumed == 5000);
+    }
+
+    void test_exact_output()
+    {
+        using namespace stlencoders;
+
+        // unpadded input followed by a newline, decoded into exactly
+        // as many octets as it holds
+        std::string s = randstr(9999);
+        std::string w = seqenc<base64<char> >(s) + "\n";
+
+        std::vector<const_buffer> in = split<const_buffer>(w.data(), w.size());
+        std::vector<char> dst(s.size());
+        std::vector<mutable_buffer> out = split<mutable_buffer>(&dst[0], dst.size());
+
+        codec_result r = base64<char>::decodev(&in[0], in.size(), &out[0], out.size(), ascii_whitespace());
+        assert(r.status == codec_done && r.consumed == w.size() && r.produced == s.size());
+        assert(std::string(&dst[0], dst.size()) == s);
+
+        const_buffer ib = { "LNkQ\n", 5 };
+        mutable_buffer ob = { &dst[0], 3 };
+        r = base64<char>::decodev(&ib, 1, &ob, 1, ascii_whitespace());
+        assert(r.status == codec_done && r.consumed == 5 && r.produced == 3);
+        assert(std::string(&dst[0], 3) == "\x2c\xd9\x10");
+    }
+
+#if defined(STLENCODERS_IOVEC)
+    void test_iovec()
+    {
+        using namespace stlencoders;
+
+        std::string s = randstr(1000);
+        std::string e = seqenc<base32<char> >(s);
+
+        std::vector<iovec> in = split<iovec>(&s[0], s.size());
+        std::string t(e.size(), '\0');
+        std::vector<iovec> out = split<iovec>(&t[0], t.size());
+
+        codec_result r = base32<char>::encodev(&in[0], in.size(), &out[0], out.size());
+        assert(r.status == codec_done && t == e);
+    }
+#endif
+
+    void test_levels()
+    {
+        using namespace stlencoders;
+
+        test_codec<base2<char> >();
+        test_codec<base16<char> >();
+        test_codec<base32<char> >();
+        test_codec<base64<char> >();
+        test_codec<base64<char, base64url_traits<char> > >();
+
+        test_skip();
+        test_exact_output();
+
+#if defined(STLENCODERS_IOVEC)
+        test_iovec();
+#endif
+    }
+}
+
+void test_buffer()
+{
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_buffer();
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_chunk.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+    struct newline {
+        template<class charT>
+        bool operator()(charT c) const {
+            return c == charT('\n');
+        }
+    };
+
+    std::size_t chunk_size(std::size_t n)
+    {
+        return std::min<std::size_t>(std::rand() % 40, n);
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> chunkenc(
+        typename C::encoder& e, const std::string& src
+        )
+    {
+        typedef typename C::char_type char_type;
+
+        std::vector<char_type> dst(C::max_encode_size(src.size()) + 1);
+        const char* first = src.data();
+        const char* last = first + src.size();
+        char_type* end = &dst[0];
+        while (first != last) {
+            std::size_t n = chunk_size(last - first);
+            end = e.update(first, first + n, end);
+            first += n;
+        }
+        end = e.finish(end);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::basic_string<char_type>(&dst[0], end);
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> seqchunkenc(
+        typename C::encoder& e, const std::string& src
+        )
+    {
+        std::basic_string<typename C::char_type> dst;
+        for (std::size_t i = 0; i != src.size(); ) {
+            std::size_t n = chunk_size(src.size() - i);
+            std::list<char> seq(src.begin() + i, src.begin() + i + n);
+            e.update(seq.begin(), seq.end(), std::back_inserter(dst));
+            i += n;
+        }
+        e.finish(std::back_inserter(dst));
+        return dst;
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> backchunkenc(
+        typename C::encoder& e, const std::string& src
+        )
+    {
+        std::basic_string<typename C::char_type> dst;
+        for (std::size_t i = 0; i != src.size(); ) {
+            std::size_t n = chunk_size(src.size() - i);
+            e.update(src.begin() + i, src.begin() + i + n, std::back_inserter(dst));
+            i += n;
+        }
+        e.finish(std::back_inserter(dst));
+        return dst;
+    }
+
+    template<class C>
+    std::string chunkdec(const std::basic_string<typename C::char_type>& src)
+    {
+        typedef typename C::char_type char_type;
+
+        typename C::decoder d;
+        std::vector<char> dst(C::max_decode_size(src.size()) + 1);
+        const char_type* first = src.data();
+        const char_type* last = first + src.size();
+        char* end = &dst[0];
+        while (first != last) {
+            std::size_t n = chunk_size(last - first);
+            end = d.update(first, first + n, end);
+            first += n;
+        }
+        end = d.finish(end);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::string(&dst[0], end);
+    }
+
+    template<class C, class Predicate>
+    std::string chunkdec(const std::basic_string<typename C::char_type>& src, Predicate pred)
+    {
+        typedef typename C::char_type char_type;
+
+        typename C::decoder d;
+        std::vector<char> dst(C::max_decode_size(src.size()) + 1);
+        const char_type* first = src.data();
+        const char_type* last = first + src.size();
+        char* end = &dst[0];
+        while (first != last) {
+            std::size_t n = chunk_size(last - first);
+            end = d.update(first, first + n, end, pred);
+            first += n;
+        }
+        end = d.finish(end);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::string(&dst[0], end);
+    }
+
+    template<class C, class Predicate>
+    std::string seqchunkdec(const std::basic_string<typename C::char_type>& src, Predicate pred)
+    {
+        typename C::decoder d;
+        std::string dst;
+        for (std::size_t i = 0; i != src.size(); ) {
+            std::size_t n = chunk_size(src.size() - i);
+            std::list<typename C::char_type> seq(src.begin() + i, src.begin() + i + n);
+            d.update(seq.begin(), seq.end(), std::back_inserter(dst), pred);
+            i += n;
+        }
+        d.finish(std::back_inserter(dst));
+        return dst;
+    }
+
+    /*
+     * Encodes src using process() with input and output ranges of
+     * random size, each output range allocated exactly.
+     */
+    template<class C>
+    std::basic_string<typename C::char_type> boundenc(
+        typename C::encoder& e, const std::string& src
+        )
+    {
+        typedef typename C::char_type char_type;
+
+        std::basic_string<char_type> dst;
+        const char* first = src.data();
+        const char* last = first + src.size();
+        for (;;) {
+            std::size_t n = chunk_size(last - first);
+            std::vector<char_type> buf(std::rand() % 24 + 1);
+            bool final = first + n == last;
+            stlencoders::codec_result r = e.process(first, n, &buf[0], buf.size(), final);
+            assert(r.consumed <= n && r.produced <= buf.size());
+            dst.append(&buf[0], r.produced);
+            first += r.consumed;
+            if (r.status == stlencoders::codec_done) {
+                assert(final && r.consumed == n);
+                return dst;
+            }
+            assert(r.status == stlencoders::codec_need_input ?
+                   r.consumed == n : r.produced == buf.size());
+        }
+    }
+
+    template<class C, class Predicate>
+    stlencoders::codec_status bounddec(
+        const std::basic_string<typename C::char_type>& src, Predicate pred,
+        std::string& dst, std::size_t& offset
+        )
+    {
+        typedef typename C::char_type char_type;
+
+        typename C::decoder d;
+        const char_type* first = src.data();
+        const char_type* last = first + src.size();
+        for (;;) {
+            std::size_t n = chunk_size(last - first);
+            std::vector<unsigned char> buf(std::rand() % 24 + 1);
+            bool final = first + n == last;
+            stlencoders::codec_result r = d.process(first, n, &buf[0], buf.size(), final, pred);
+            assert(r.consumed <= n && r.produced <= buf.size());
+            dst.append(buf.begin(), buf.begin() + r.produced);
+            first += r.consumed;
+            if (r.status == stlencoders::codec_done || r.status == stlencoders::codec_error) {
+                offset = first - src.data();
+                return r.status;
+            }
+            assert(r.status == stlencoders::codec_need_input ?
+                   r.consumed == n : r.produced == buf.size());
+        }
+    }
+
+    template<class C>
+    std::string bounddec(const std::basic_string<typename C::char_type>& src)
+    {
+        std::string dst;
+        std::size_t offset;
+        assert(bounddec<C>(src, make_skip(""), dst, offset) == stlencoders::codec_done);
+        return dst;
+    }
+
+    template<class C>
+    void test_codec()
+    {
+        typedef typename C::char_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        typename C::encoder enc;
+
+        for (std::size_t n = 0; n < 4000; n += 1 + n / 4) {
+            std::string s = randstr(n);
+            string_type e = seqenc<C>(s);
+
+            assert(chunkenc<C>(enc, s) == e);
+            assert(seqchunkenc<C>(enc, s) == e);
+            assert(backchunkenc<C>(enc, s) == e);
+
+            assert(chunkdec<C>(e) == s);
+            assert(chunkdec<C>(wrap(e, 76), newline()) == s);
+            assert(seqchunkdec<C>(wrap(e, 64), newline()) == s);
+
+            assert(boundenc<C>(enc, s) == e);
+            assert(bounddec<C>(e) == s);
+
+            // padding ends decoding before any trailing characters
+            typename string_type::size_type m = e.find(char_type('='));
+            if (m == string_type::npos) {
+                m = e.size();
+            }
+            if (m != 0) {
+                string_type t = e;
+                std::size_t k = std::rand() % m;
+                t[k] = char_type('?');
+                assert_throw(chunkdec<C>(t), stlencoders::invalid_character);
+
+                std::string dst;
+                std::size_t offset;
+                assert(bounddec<C>(t, newline(), dst, offset) == stlencoders::codec_error);
+                assert(offset == k);
+                assert(dst.size() <= k);
+            }
+        }
+
+        // finish() resets the encoder
+        std::string s = randstr(100);
+        char_type buf[256];
+        enc.update(s.data(), s.data() + 1, buf);
+        enc.reset();
+        assert(chunkenc<C>(enc, s) == seqenc<C>(s));
+    }
+
+    template<class C>
+    void test_padding()
+    {
+        typedef typename C::char_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        typename C::encoder enc(false);
+
+        for (std::size_t n = 0; n < 1000; ++n) {
+            std::string s = randstr(n);
+            string_type e = seqenc<C>(s, false);
+
+            assert(chunkenc<C>(enc, s) == e);
+            assert(chunkdec<C>(e) == s);
+            assert(boundenc<C>(enc, s) == e);
+
+            string_type t = seqenc<C>(s);
+            t += seqenc<C>(s);
+            assert(chunkdec<C>(t) == ptrdec<C>(t));
+            assert(bounddec<C>(t) == ptrdec<C>(t));
+        }
+    }
+
+    template<class C>
+    void test_length(const char* src)
+    {
+        typename C::decoder d;
+        char buf[16];
+        std::string s(src);
+
+        d.update(s.begin(), s.end(), buf);
+        assert_throw(d.finish(buf), stlencoders::invalid_length);
+
+        // the decoder is reset
+        assert(d.finish(buf) == buf);
+
+        std::string dst;
+        std::size_t offset;
+        assert(bounddec<C>(s, make_skip(""), dst, offset) == stlencoders::codec_error);
+        assert(offset == s.size());
+    }
+
+    void test_skip_set()
+    {
+        using namespace stlencoders;
+
+        ascii_whitespace ws;
+
+        for (std::size_t n = 0; n < 4000; n += 1 + n / 4) {
+            std::string s = randstr(n);
+            std::string e = wrap(seqenc<base64<char> >(s), 76);
+            assert(chunkdec<base64<char> >(e, ws) == s);
+
+            std::string dst;
+            std::size_t offset;
+            assert(bounddec<base64<char> >(e, ws, dst, offset) == codec_done);
+            assert(dst == s);
+        }
+    }
+
+    void test_exact_output()
+    {
+        using namespace stlencoders;
+
+        base64<char>::decoder d;
+        ascii_whitespace ws;
+        unsigned char buf[3];
+        codec_result r;
+
+        // characters producing no output are consumed when the output is full
+        r = d.process("LNkQ\n", 5, buf, sizeof buf, true, ws);
+        assert(r.status == codec_done && r.consumed == 5 && r.produced == 3);
+        assert(buf[0] == 0x2c && buf[1] == 0xd9 && buf[2] == 0x10);
+
+        r = d.process("LNkQ=", 5, buf, sizeof buf, true, make_skip(""));
+        assert(r.status == codec_done && r.consumed == 5 && r.produced == 3);
+
+        r = d.process("LNkQ\n", 5, buf, sizeof buf, false, ws);
+        assert(r.status == codec_need_input && r.consumed == 5 && r.produced == 3);
+        r = d.process("\n", 1, buf, 0, false, ws);
+        assert(r.status == codec_need_input && r.consumed == 1 && r.produced == 0);
+        r = d.process("", 0, buf, 0, true, ws);
+        assert(r.status == codec_done && r.consumed == 0 && r.produced == 0);
+
+        // a further quantum is held back until there is room for it
+        r = d.process("LNkQLNkQ", 8, buf, sizeof buf, true, ws);
+        assert(r.status == codec_output_full && r.consumed == 8 && r.produced == 3);
+        r = d.process("", 0, buf, sizeof buf, true, ws);
+        assert(r.status == codec_done && r.consumed == 0 && r.produced == 3);
+    }
+
+    void test_levels()
+    {
+        using namespace stlencoders;
+
+        test_codec<base2<char> >();
+        test_codec<base16<char> >();
+        test_codec<base32<char> >();
+        test_codec<base32<char, base32hex_traits<char> > >();
+        test_codec<base64<char> >();
+        test_codec<base64<char, base64url_traits<char> > >();
+
+        test_codec<base16<wchar_t> >();
+        test_codec<base64<wchar_t> >();
+
+        test_padding<base32<char> >();
+        test_padding<base64<char> >();
+
+        test_skip_set();
+        test_exact_output();
+    }
+}
+
+void test_chunk()
+{
+    using namespace stlencoders;
+
+    test_length<base2<char> >("0101");
+    test_length<base16<char> >("A");
+    test_length<base16<char> >("ABC");
+    test_length<base32<char> >("A");
+    test_length<base32<char> >("AAA");
+    test_length<base32<char> >("AAAAAA");
+    test_length<base32<char> >("AAAAAAAAAAAAAA=");
+    test_length<base64<char> >("A");
+    test_length<base64<char> >("AAAAA===");
+
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_chunk();
+    return EXIT_SUCCESS;
+}
+#endif
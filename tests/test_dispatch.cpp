@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dispatch.hpp"
+
+#include <cassert>
+#include <cstdlib>
+
+namespace {
+    int nselect = 0;
+
+    int scalar(int) { return stlencoders::simd_scalar; }
+    int ssse3(int) { return stlencoders::simd_ssse3; }
+    int avx2(int) { return stlencoders::simd_avx2; }
+    int avx512(int) { return stlencoders::simd_avx512; }
+
+    struct test_kernel {
+        typedef int (*function_type)(int);
+
+        static function_type select(stlencoders::simd_level level) {
+            ++nselect;
+
+            switch (level) {
+            case stlencoders::simd_avx512:
+                return avx512;
+            case stlencoders::simd_avx2:
+                return avx2;
+            case stlencoders::simd_ssse3:
+                return ssse3;
+            default:
+                return scalar;
+            }
+        }
+    };
+}
+
+void test_dispatch()
+{
+    using namespace stlencoders;
+
+    typedef detail::dispatch<test_kernel> dispatch;
+
+    simd_level level = detect_simd_level();
+
+    // kernels are resolved once
+
+    assert(dispatch::get()(0) == get_simd_level());
+    assert(dispatch::get()(0) == get_simd_level());
+    assert(nselect == 1);
+
+    // kernels are resolved again after changing the level
+
+    for (int i = simd_scalar; i <= simd_avx512; ++i) {
+        simd_level l = set_simd_level(simd_level(i));
+        assert(l == (i <= level ? i : level));
+        assert(get_simd_level() == l);
+        assert(dispatch::get()(0) == l);
+        assert(dispatch::get()(0) == l);
+    }
+    assert(nselect == 5);
+
+    set_simd_level(level);
+    assert(dispatch::get()(0) == level);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_dispatch();
+    return EXIT_SUCCESS;
+}
+#endif
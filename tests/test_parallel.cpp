@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "test_parallel.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "parallel.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+    template<class C>
+    std::string parenc(const stlencoders::parallel_policy& policy, const std::string& s)
+    {
+        std::string t(C::max_encode_size(s.size()), '\0');
+        std::string::iterator end = C::encode(policy, s.begin(), s.end(), t.begin());
+        t.erase(end, t.end());
+        return t;
+    }
+
+    template<class C>
+    std::string pardec(const stlencoders::parallel_policy& policy, const std::string& s)
+    {
+        std::vector<char> v(C::max_decode_size(s.size()) + 1);
+        const char* p = s.data();
+        return std::string(&v[0], C::decode(policy, p, p + s.size(), &v[0]));
+    }
+
+    template<class C, class Predicate>
+    std::string pardec(const stlencoders::parallel_policy& policy, const std::string& s, Predicate skip)
+    {
+        std::vector<char> v(C::max_decode_size(s.size()) + 1);
+        const char* p = s.data();
+        return std::string(&v[0], C::decode(policy, p, p + s.size(), &v[0], skip));
+    }
+
+    template<class C, class Predicate>
+    void test_skip(const stlencoders::parallel_policy& policy, Predicate skip)
+    {
+        for (std::size_t n = 0; n < 4000; n += 1 + n / 4) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+
+            assert(pardec<C>(policy, e, skip) == s);
+            assert(pardec<C>(policy, scatter(e, 3), skip) == s);
+            assert(pardec<C>(policy, scatter(e, 200), skip) == s);
+
+            // line breaks every 76 characters
+            assert(pardec<C>(policy, wrap(e, 76, "\r\n"), skip) == s);
+
+            // decoding ends at the first padding in any chunk
+            std::string::size_type m = e.find('=');
+            if (m != std::string::npos) {
+                assert(pardec<C>(policy, scatter(e + e, 3), skip) == s);
+                assert(pardec<C>(policy, scatter(e, 3) + " ?", skip) == s);
+            }
+
+            if (!e.empty()) {
+                std::string t = e;
+                t[std::rand() % std::min(m, t.size())] = '?';
+                assert_throw(pardec<C>(policy, scatter(t, 3), skip), stlencoders::invalid_character);
+            }
+        }
+
+        // whitespace-only chunks between quanta
+        std::string s = randstr(4095);
+        std::string e = seqenc<C>(s);
+        std::string t = e.substr(0, 1000) + std::string(5000, ' ') + e.substr(1000);
+        assert(pardec<C>(policy, t, skip) == s);
+        assert(pardec<C>(policy, std::string(5000, '\n'), skip).empty());
+        assert_throw(pardec<C>(policy, scatter(e + e.substr(0, 1), 3), skip), stlencoders::invalid_length);
+        assert_throw(pardec<C>(policy, scatter(e, 3) + "\n" + e.substr(0, 1) + "\n", skip), stlencoders::invalid_length);
+
+        // the first error in input order is reported
+        t = scatter(e + e, 3);
+        t[t.size() / 2] = '?';
+        t.insert(t.size() - 1, e.substr(0, 1));
+        assert_throw(pardec<C>(policy, t, skip), stlencoders::invalid_character);
+    }
+
+    template<class C>
+    void test_codec(const stlencoders::parallel_policy& policy)
+    {
+        for (std::size_t n = 0; n < 10000; n += 1 + n / 8) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+
+            assert(parenc<C>(policy, s) == e);
+            assert(pardec<C>(policy, e) == s);
+
+            // decoding ends at the first padding in any chunk
+            std::string::size_type m = e.find('=');
+            if (m != std::string::npos) {
+                assert(pardec<C>(policy, e + e) == s);
+                assert(pardec<C>(policy, e + e + "?") == s);
+            }
+
+            if (!e.empty()) {
+                std::string t = e;
+                t[std::rand() % std::min(m, t.size())] = '?';
+                assert_throw(pardec<C>(policy, t), stlencoders::invalid_character);
+            }
+            if (m == std::string::npos) {
+                assert_throw(pardec<C>(policy, e + "?"), stlencoders::invalid_character);
+            }
+        }
+
+        // a multiple of all quantum sizes, so there is no padding
+        std::string s = randstr(4095);
+        std::string e = seqenc<C>(s);
+        assert_throw(pardec<C>(policy, e + e.substr(0, 1)), stlencoders::invalid_length);
+
+        // the first error in input order is reported
+        std::string t = e + e;
+        t[e.size() + 10] = '?';
+        t.insert(t.size() - 1, e.substr(0, 1));
+        assert_throw(pardec<C>(policy, t), stlencoders::invalid_character);
+    }
+
+    template<class C, class Predicate>
+    void test_chunked(const stlencoders::parallel_policy& policy, Predicate skip)
+    {
+        for (std::size_t n = 0; n < 20000; n += 1 + n / 2) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+            std::string w = scatter(e, 3);
+
+            // split input into pieces of random size
+            std::string t(C::max_encode_size(s.size()), '\0');
+            typename C::encoder enc;
+            std::string::iterator out = t.begin();
+            for (std::string::size_type i = 0, m; i != s.size(); i += m) {
+                m = std::min(std::rand() % 5000 + std::size_t(1), s.size() - i);
+                out = enc.update(policy, s.begin() + i, s.begin() + i + m, out);
+            }
+            t.erase(enc.finish(out), t.end());
+            assert(t == e);
+
+            std::vector<char> v(C::max_decode_size(w.size()) + 1);
+            typename C::decoder dec;
+            char* r = &v[0];
+            for (std::string::size_type i = 0, m; i != w.size(); i += m) {
+                m = std::min(std::rand() % 5000 + std::size_t(1), w.size() - i);
+                r = dec.update(policy, w.data() + i, w.data() + i + m, r, skip);
+            }
+            assert(std::string(&v[0], dec.finish(r)) == s);
+
+            if (!e.empty()) {
+                w[std::rand() % std::min(w.find('='), w.size())] = '?';
+                typename C::decoder bad;
+                assert_throw(bad.update(policy, w.data(), w.data() + w.size(), &v[0], skip), stlencoders::invalid_character);
+            }
+        }
+
+        // decoding ends at the first padding
+        std::string s = randstr(4001);
+        std::string e = seqenc<C>(s);
+        if (e.find('=') != std::string::npos) {
+            std::vector<char> v(C::max_decode_size(e.size()));
+            typename C::decoder dec;
+            char* r = dec.update(policy, e.data(), e.data() + e.size(), &v[0]);
+            r = dec.update(policy, e.data(), e.data() + e.size(), r);
+            assert(std::string(&v[0], dec.finish(r)) == s);
+        }
+    }
+
+    void test_policy(const stlencoders::parallel_policy& policy)
+    {
+        // have kernels resolved by concurrent chunks
+        stlencoders::set_simd_level(stlencoders::detect_simd_level());
+
+        typedef stlencoders::base64<char> base64;
+        typedef stlencoders::base32<char> base32;
+        typedef stlencoders::base16<char> base16;
+        typedef stlencoders::base2<char> base2;
+
+        test_codec<base64>(policy);
+        test_codec<base32>(policy);
+        test_codec<base16>(policy);
+        test_codec<base2>(policy);
+
+        stlencoders::ascii_whitespace ws;
+        test_skip<base64>(policy, ws);
+        test_skip<base32>(policy, ws);
+        test_skip<base16>(policy, ws);
+        test_skip<base2>(policy, ws);
+        test_skip<base64>(policy, make_skip(whitespace));
+        test_skip<base2>(policy, make_skip(whitespace));
+
+        test_chunked<base64>(policy, ws);
+        test_chunked<base32>(policy, ws);
+        test_chunked<base16>(policy, ws);
+        test_chunked<base2>(policy, ws);
+
+        // padding is only performed by the last chunk
+        std::string s = randstr(1000);
+        std::string t(base64::max_encode_size(s.size()), '\0');
+        t.erase(base64::encode(policy, s.begin(), s.end(), t.begin(), false), t.end());
+        assert(t == seqenc<base64>(s, false));
+        t.assign(base32::max_encode_size(s.size()), '\0');
+        t.erase(base32::encode(policy, s.begin(), s.end(), t.begin(), false), t.end());
+        assert(t == seqenc<base32>(s, false));
+    }
+}
+
+void test_parallel()
+{
+    assert(stlencoders::parallel_policy(4, 100).threads(0) == 1);
+    assert(stlencoders::par.threads(1) == 1);
+#if defined(STLENCODERS_THREADS)
+    assert(stlencoders::parallel_policy(4, 100).threads(250) == 2);
+    assert(stlencoders::parallel_policy(4, 100).threads(1000) == 4);
+#else
+    assert(stlencoders::parallel_policy(4, 100).threads(1000) == 1);
+#endif
+
+    test_policy(stlencoders::par);
+    test_policy(stlencoders::parallel_policy(3, 1));
+    test_policy(stlencoders::parallel_policy(4, 64));
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_parallel();
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "test_skip.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <string>
+
+namespace {
+    template<class C>
+    void test_codec()
+    {
+        stlencoders::ascii_whitespace ws;
+
+        for (std::size_t n = 0; n < 10000; n += 1 + n / 8) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+
+            assert(ptrdec<C>(wrap(e, 76, "\r\n"), ws) == s);
+            assert(ptrdec<C>(wrap(e, 64, "\n"), ws) == s);
+            assert(strdec<C>(scatter(e), ws) == s);
+
+            std::string t = scatter(e);
+            assert(ptrdec<C>(t, ws) == seqdec<C>(t, make_skip(whitespace)));
+
+            // padding ends decoding before any trailing characters
+            std::string::size_type m = t.find('=');
+            if (m == std::string::npos) {
+                m = t.size();
+            }
+            if (m != 0) {
+                t[std::rand() % m] = '?';
+                assert_throw(ptrdec<C>(t, ws), stlencoders::invalid_character);
+            }
+        }
+    }
+
+    template<class C>
+    void test_padding()
+    {
+        stlencoders::ascii_whitespace ws;
+
+        // padding ends decoding at any position, including chunk
+        // boundaries of the compacted input
+        for (std::size_t n = 3000; n != 3100; ++n) {
+            std::string s = randstr(n);
+            std::string e = wrap(seqenc<C>(s), 76, "\r\n");
+
+            assert(ptrdec<C>(e + e, ws) == seqdec<C>(e + e, make_skip(whitespace)));
+        }
+    }
+
+    void test_levels()
+    {
+        typedef stlencoders::base64<char> base64;
+        typedef stlencoders::base64<char, stlencoders::base64url_traits<char> > base64url;
+        typedef stlencoders::base32<char> base32;
+        typedef stlencoders::base32<char, stlencoders::base32hex_traits<char> > base32hex;
+        typedef stlencoders::base16<char> base16;
+        typedef stlencoders::base2<char> base2;
+
+        test_codec<base64>();
+        test_codec<base64url>();
+        test_codec<base32>();
+        test_codec<base32hex>();
+        test_codec<base16>();
+        test_codec<base2>();
+
+        test_padding<base64>();
+        test_padding<base32>();
+
+        // alphabet characters are never skipped
+        stlencoders::skip_set a("A\n");
+        assert(ptrdec<base64>("QUFB\nQUFB", a) == "AAAAAA");
+        assert_throw(ptrdec<base64>("QUFB?QUFB", a), stlencoders::invalid_character);
+
+        // skipped padding characters
+        stlencoders::skip_set pad("=");
+        assert(ptrdec<base64>("Zg==Zg==", pad) == seqdec<base64>("Zg==Zg==", make_skip("=")));
+    }
+}
+
+void test_skip()
+{
+    using namespace stlencoders;
+
+    skip_set empty;
+    for (int c = 0; c != 256; ++c) {
+        assert(!empty(static_cast<char>(c)));
+    }
+
+    ascii_whitespace ws;
+    for (int c = 0; c != 256; ++c) {
+        bool space = c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        assert(ws(static_cast<char>(c)) == space);
+    }
+    assert(ws(L' '));
+    assert(ws(L'\n'));
+    assert(!ws(L'A'));
+    assert(!ws(static_cast<wchar_t>(0x100 | ' ')));
+
+    skip_set s("\x80\xff");
+    assert(s('\x80'));
+    assert(s('\xff'));
+    assert(s(static_cast<unsigned char>(0xff)));
+    assert(!s('\x7f'));
+    assert(s.insert('x')('x'));
+
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_skip();
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_streambuf.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "skip.hpp"
+#include "streambuf.hpp"
+#include "util.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::size_t sizes[] = {
+        0, 1, 2, 3, 4, 5, 7, 8, 100, 4096, 65535, 65536, 65537, 200000
+    };
+
+    /*
+     * Writes src through an encoding stream buffer using a mix of
+     * single characters, short writes and long writes.
+     */
+    template<class C>
+    std::basic_string<typename C::char_type> streamenc(
+        const std::string& src,
+        const typename C::encoder& e = typename C::encoder()
+        )
+    {
+        typedef typename C::char_type char_type;
+
+        std::basic_stringbuf<char_type> sb;
+        {
+            stlencoders::basic_encoding_streambuf<C> esb(&sb, e);
+            std::ostream os(&esb);
+
+            for (std::size_t i = 0; i != src.size(); ) {
+                std::size_t n = std::rand() % 3 == 0 ? std::rand() % 100000 : std::rand() % 10;
+                if (n > src.size() - i) {
+                    n = src.size() - i;
+                }
+                if (n == 1) {
+                    os.put(src[i]);
+                } else {
+                    os.write(src.data() + i, n);
+                }
+                if (std::rand() % 10 == 0) {
+                    os.flush();
+                }
+                i += n;
+            }
+            assert(os);
+        }
+        return sb.str();
+    }
+
+    template<class C, class Predicate>
+    std::string streamdec(
+        const std::basic_string<typename C::char_type>& src, Predicate skip
+        )
+    {
+        typedef typename C::char_type char_type;
+
+        std::basic_stringbuf<char_type> sb(src);
+        stlencoders::basic_decoding_streambuf<C, Predicate> dsb(&sb, skip);
+        std::istream is(&dsb);
+
+        std::string dst;
+        std::vector<char> buf(200000);
+        for (;;) {
+            std::size_t n = std::rand() % 3 == 0 ? std::rand() % buf.size() : std::rand() % 10;
+            if (n == 1) {
+                int c = is.get();
+                if (c == std::char_traits<char>::eof()) {
+                    break;
+                }
+                dst += static_cast<char>(c);
+            } else {
+                is.read(&buf[0], n);
+                dst.append(&buf[0], static_cast<std::size_t>(is.gcount()));
+                if (!is) {
+                    break;
+                }
+            }
+        }
+        assert(is.eof() && !is.bad());
+        return dst;
+    }
+
+    template<class C>
+    void test_codec()
+    {
+        typedef typename C::char_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        for (std::size_t i = 0; i != sizeof sizes / sizeof sizes[0]; ++i) {
+            std::string s = randstr(sizes[i]);
+            string_type e = seqenc<C>(s);
+
+            assert(streamenc<C>(s) == e);
+            assert(streamdec<C>(e, stlencoders::skip_set()) == s);
+            assert(streamdec<C>(wrap(e, 76), make_skip(L"\n")) == s);
+        }
+    }
+
+    template<class C>
+    void test_padding()
+    {
+        for (std::size_t i = 0; i != sizeof sizes / sizeof sizes[0]; ++i) {
+            std::string s = randstr(sizes[i]);
+            assert(streamenc<C>(s, typename C::encoder(false)) == seqenc<C>(s, false));
+        }
+    }
+
+    template<class C>
+    void test_errors()
+    {
+        std::string e = seqenc<C>(randstr(100000));
+
+        std::string t = e;
+        t[50000] = '?';
+        std::stringbuf sb(t);
+        stlencoders::basic_decoding_streambuf<C> dsb(&sb);
+        std::vector<char> buf(200000);
+        assert_throw(dsb.sgetn(&buf[0], buf.size()), stlencoders::invalid_character);
+
+        // a single trailing character past the last block
+        std::string u = seqenc<C>(randstr(3 * 65536)) + "A";
+        std::stringbuf usb(u);
+        stlencoders::basic_decoding_streambuf<C> udsb(&usb);
+        assert(udsb.sgetn(&buf[0], 65536) == 65536);
+        assert_throw(udsb.sgetn(&buf[0], buf.size()), stlencoders::invalid_length);
+    }
+}
+
+void test_streambuf()
+{
+    using namespace stlencoders;
+
+    test_codec<base2<char> >();
+    test_codec<base16<char> >();
+    test_codec<base32<char> >();
+    test_codec<base64<char> >();
+    test_codec<base64<wchar_t> >();
+
+    test_padding<base32<char> >();
+    test_padding<base64<char> >();
+
+    test_errors<base64<char> >();
+
+    // whitespace in wrapped input
+    std::string s = randstr(100000);
+    std::string e = wrap(seqenc<base64<char> >(s), 76);
+    assert(streamdec<base64<char> >(e, ascii_whitespace()) == s);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_streambuf();
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "test_try_decode.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct outcome {
+        stlencoders::decode_status status;
+        std::size_t offset;
+        std::string octets;
+
+        bool operator==(const outcome& rhs) const {
+            return status == rhs.status && offset == rhs.offset && octets == rhs.octets;
+        }
+    };
+
+    template<class OutputIterator>
+    outcome make_outcome(const stlencoders::decode_result<OutputIterator>& r, const std::string& s)
+    {
+        outcome o;
+        o.status = r.status;
+        o.offset = r.offset;
+        o.octets = s;
+        return o;
+    }
+
+    template<class C, class Predicate>
+    outcome ptrtry(const std::string& t, Predicate skip)
+    {
+        std::vector<unsigned char> v(C::max_decode_size(t.size()) + 1);
+        const char* p = t.data();
+        stlencoders::decode_result<unsigned char*> r =
+            C::try_decode(p, p + t.size(), &v[0], skip);
+        return make_outcome(r, std::string(&v[0], r.result));
+    }
+
+    template<class C, class Predicate>
+    outcome lsttry(const std::string& t, Predicate skip)
+    {
+        std::list<char> l(t.begin(), t.end());
+        std::string s;
+        return make_outcome(C::try_decode(l.begin(), l.end(), std::back_inserter(s), skip), s);
+    }
+
+    template<class C, class Predicate>
+    outcome strtry(const std::string& t, Predicate skip)
+    {
+        std::istringstream is(t);
+        std::istreambuf_iterator<char> first(is);
+        std::istreambuf_iterator<char> last;
+        std::string s;
+        return make_outcome(C::try_decode(first, last, std::back_inserter(s), skip), s);
+    }
+
+    template<class C>
+    outcome trydec(const std::string& t)
+    {
+        outcome o = ptrtry<C>(t, stlencoders::skip_set());
+        assert(lsttry<C>(t, make_skip("")) == o);
+        assert(strtry<C>(t, make_skip("")) == o);
+        return o;
+    }
+
+    template<class C>
+    outcome trydec(const std::string& t, const stlencoders::skip_set& skip)
+    {
+        outcome o = ptrtry<C>(t, skip);
+        assert(lsttry<C>(t, make_skip(whitespace)) == o);
+        assert(strtry<C>(t, make_skip(whitespace)) == o);
+        return o;
+    }
+
+    template<class C, std::size_t Chars, std::size_t Octets>
+    void test_codec()
+    {
+        using stlencoders::decode_ok;
+        using stlencoders::decode_invalid_character;
+        using stlencoders::decode_invalid_length;
+
+        stlencoders::ascii_whitespace ws;
+        const char x = seqenc<C>(std::string(1, '\0'))[0];
+
+        for (std::size_t n = 0; n < 5000; n += 1 + n / 8) {
+            std::string s = randstr(n);
+            std::string e = seqenc<C>(s);
+            std::string::size_type m = e.find('=');
+
+            // decoding stops at padding
+            outcome o = trydec<C>(e);
+            assert(o.status == decode_ok);
+            assert(o.offset == std::min(m, e.size()));
+            assert(o.octets == s);
+
+            if (m == std::string::npos) {
+                // an extra character leaves an incomplete quantum
+                o = trydec<C>(e + x);
+                assert(o.status == decode_invalid_length);
+                assert(o.offset == e.size() + 1);
+                assert(o.octets == s);
+                m = e.size();
+            } else {
+                // padding ends decoding before any trailing characters
+                o = trydec<C>(e + x);
+                assert(o.status == decode_ok);
+                assert(o.offset == m);
+                assert(o.octets == s);
+            }
+
+            if (m != 0) {
+                std::string t = e;
+                std::size_t i = std::rand() % m;
+                t[i] = '?';
+                o = trydec<C>(t);
+                assert(o.status == decode_invalid_character);
+                assert(o.offset == i);
+                // complete quanta before the error are decoded
+                assert(o.octets.size() >= i / Chars * Octets);
+                assert(o.octets.size() < (i / Chars + 1) * Octets);
+                assert(o.octets == s.substr(0, o.octets.size()));
+            }
+
+            // offsets refer to the input before skipped characters
+            // were removed
+            std::string t = scatter(e);
+            m = t.find('=');
+            o = trydec<C>(t, ws);
+            assert(o.status == decode_ok);
+            assert(o.offset == std::min(m, t.size()));
+            assert(o.octets == s);
+
+            if (m == std::string::npos) {
+                o = trydec<C>(t + x + '\n', ws);
+                assert(o.status == decode_invalid_length);
+                assert(o.offset == t.size() + 2);
+                m = t.size();
+            } else {
+                o = trydec<C>(t + x, ws);
+                assert(o.status == decode_ok);
+                assert(o.offset == m);
+            }
+
+            if (m != 0) {
+                std::size_t i = std::rand() % m;
+                t[i] = '?';
+                o = trydec<C>(t, ws);
+                assert(o.status == decode_invalid_character);
+                assert(o.offset == i);
+            }
+        }
+    }
+
+    void test_levels()
+    {
+        typedef stlencoders::base64<char> base64;
+        typedef stlencoders::base64<char, stlencoders::base64url_traits<char> > base64url;
+        typedef stlencoders::base32<char> base32;
+        typedef stlencoders::base32<char, stlencoders::base32hex_traits<char> > base32hex;
+        typedef stlencoders::base16<char> base16;
+        typedef stlencoders::base2<char> base2;
+
+        test_codec<base64, 4, 3>();
+        test_codec<base64url, 4, 3>();
+        test_codec<base32, 8, 5>();
+        test_codec<base32hex, 8, 5>();
+        test_codec<base16, 2, 1>();
+        test_codec<base2, 8, 1>();
+    }
+}
+
+void test_try_decode()
+{
+    typedef stlencoders::base64<char> base64;
+
+    const char* s = "Zm9vYmFy!";
+    unsigned char buf[6];
+    stlencoders::decode_result<unsigned char*> r = base64::try_decode(s, s + 9, buf);
+    assert(r.status == stlencoders::decode_invalid_character);
+    assert(r.result == buf + 6);
+    assert(r.offset == 8);
+
+    r = base64::try_decode(s, s + 5, buf);
+    assert(r.status == stlencoders::decode_invalid_length);
+    assert(r.result == buf + 3);
+    assert(r.offset == 5);
+
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_try_decode();
+    return EXIT_SUCCESS;
+}
+#endif
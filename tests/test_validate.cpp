@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "test_validate.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "skip.hpp"
+#include "util.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+    // validation must agree with decoding
+    template<class C>
+    void check(const std::string& t)
+    {
+        std::vector<unsigned char> v(C::max_decode_size(t.size()) + 1);
+        stlencoders::decode_result<unsigned char*> d =
+            C::try_decode(t.data(), t.data() + t.size(), &v[0]);
+
+        stlencoders::validate_result r = C::validate(t.data(), t.data() + t.size());
+        assert(r.status == d.status);
+        assert(r.offset == d.offset);
+        assert(C::is_valid(t.begin(), t.end()) == (d.status == stlencoders::decode_ok));
+
+        std::list<char> l(t.begin(), t.end());
+        r = C::validate(l.begin(), l.end());
+        assert(r.status == d.status);
+        assert(r.offset == d.offset);
+    }
+
+    template<class C>
+    void check(const std::string& t, const stlencoders::skip_set& skip)
+    {
+        std::vector<unsigned char> v(C::max_decode_size(t.size()) + 1);
+        stlencoders::decode_result<unsigned char*> d =
+            C::try_decode(t.data(), t.data() + t.size(), &v[0], skip);
+
+        stlencoders::validate_result r = C::validate(t.begin(), t.end(), skip);
+        assert(r.status == d.status);
+        assert(r.offset == d.offset);
+        assert(C::is_valid(t.data(), t.data() + t.size(), skip) == (d.status == stlencoders::decode_ok));
+
+        std::list<char> l(t.begin(), t.end());
+        r = C::validate(l.begin(), l.end(), make_skip(whitespace));
+        assert(r.status == d.status);
+        assert(r.offset == d.offset);
+    }
+
+    template<class C>
+    void test_codec()
+    {
+        stlencoders::ascii_whitespace ws;
+        const char x = seqenc<C>(std::string(1, '\0'))[0];
+
+        for (std::size_t n = 0; n < 5000; n += 1 + n / 8) {
+            std::string e = seqenc<C>(randstr(n));
+            std::string t = scatter(e);
+
+            check<C>(e);
+            check<C>(e + x);
+            check<C>(e + x + x);
+            check<C>(t, ws);
+            check<C>(t + x + '\n', ws);
+
+            for (int i = 0; i != 4 && !e.empty(); ++i) {
+                std::string s = e;
+                s[std::rand() % s.size()] = "?\n\x80="[i];
+                check<C>(s);
+                check<C>(s, ws);
+
+                s = t;
+                s[std::rand() % s.size()] = "?\n\x80="[i];
+                check<C>(s);
+                check<C>(s, ws);
+            }
+        }
+    }
+
+    void test_levels()
+    {
+        typedef stlencoders::base64<char> base64;
+        typedef stlencoders::base64<char, stlencoders::base64url_traits<char> > base64url;
+        typedef stlencoders::base32<char> base32;
+        typedef stlencoders::base32<char, stlencoders::base32hex_traits<char> > base32hex;
+        typedef stlencoders::base16<char> base16;
+        typedef stlencoders::base2<char> base2;
+
+        test_codec<base64>();
+        test_codec<base64url>();
+        test_codec<base32>();
+        test_codec<base32hex>();
+        test_codec<base16>();
+        test_codec<base2>();
+
+        // skipped padding characters
+        stlencoders::skip_set pad("=");
+        assert(base64::is_valid("Zg==Zg==", "Zg==Zg==" + 8, pad));
+        assert(!base64::is_valid("Zg==Zg=Z", "Zg==Zg=Z" + 8, pad));
+    }
+}
+
+void test_validate()
+{
+    typedef stlencoders::base64<char> base64;
+    typedef stlencoders::base16<wchar_t> base16;
+
+    const char* s = "Zm9vYmFy!";
+    stlencoders::validate_result r = base64::validate(s, s + 9);
+    assert(r.status == stlencoders::decode_invalid_character);
+    assert(r.offset == 8);
+
+    r = base64::validate(s, s + 5);
+    assert(r.status == stlencoders::decode_invalid_length);
+    assert(r.offset == 5);
+
+    assert(base64::is_valid(s, s + 8));
+    assert(base64::is_valid(s, s + 3));
+
+    const wchar_t* w = L"0a 1b";
+    assert(!base16::is_valid(w, w + 5));
+    assert(base16::is_valid(w, w + 5, make_skip(L" ")));
+
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_validate();
+    return EXIT_SUCCESS;
+}
+#endif
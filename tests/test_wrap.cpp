@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2012, 2013 Thomas Kemmer <tkemmer@computer.org>
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "test_wrap.hpp"
+
+#include "base2.hpp"
+#include "base16.hpp"
+#include "base32.hpp"
+#include "base64.hpp"
+#include "dispatch.hpp"
+#include "util.hpp"
+#include "wrap.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace {
+    const std::size_t columns[] = {
+        0, 1, 2, 3, 4, 5, 7, 8, 12, 16, 63, 64, 76, 100
+    };
+
+    template<class C>
+    void test_codec(const typename C::char_type* eol)
+    {
+        typedef typename C::char_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        for (std::size_t n = 0; n < 400; n += n < 80 ? 1 : 37) {
+            std::string s = randstr(n);
+            std::list<char> l(s.begin(), s.end());
+            string_type e = seqenc<C>(s);
+
+            for (std::size_t i = 0; i != sizeof columns / sizeof columns[0]; ++i) {
+                string_type w = wrap(e, columns[i], eol);
+
+                std::size_t size = C::wrapped_encode_size(n, columns[i], eol);
+                assert(size == w.size());
+
+                std::vector<char_type> dst(size + 1);
+                char_type* end = C::encode_wrapped(s.data(), s.data() + n, &dst[0], columns[i], eol);
+                assert(string_type(&dst[0], end) == w);
+
+                string_type t;
+                C::encode_wrapped(l.begin(), l.end(), std::back_inserter(t), columns[i], eol);
+                assert(t == w);
+            }
+        }
+    }
+
+    template<class C>
+    void test_padding(const typename C::char_type* eol)
+    {
+        typedef typename C::char_type char_type;
+        typedef std::basic_string<char_type> string_type;
+
+        for (std::size_t n = 0; n < 400; n += n < 80 ? 1 : 37) {
+            std::string s = randstr(n);
+            string_type e = seqenc<C>(s, false);
+
+            for (std::size_t i = 0; i != sizeof columns / sizeof columns[0]; ++i) {
+                string_type w = wrap(e, columns[i], eol);
+
+                std::size_t size = C::wrapped_encode_size(n, columns[i], eol, false);
+                assert(size == w.size());
+
+                std::vector<char_type> dst(size + 1);
+                char_type* end = C::encode_wrapped(s.data(), s.data() + n, &dst[0], columns[i], eol, false);
+                assert(string_type(&dst[0], end) == w);
+            }
+        }
+    }
+
+    void test_levels()
+    {
+        using namespace stlencoders;
+
+        typedef base32<char, base32hex_traits<char> > base32hex;
+        typedef base64<char, base64url_traits<char> > base64url;
+
+        test_codec<base2<char> >("\n");
+        test_codec<base16<char> >("\r\n");
+        test_codec<base32<char> >("\n");
+        test_codec<base32hex>("\r\n");
+        test_codec<base64<char> >("\r\n");
+        test_codec<base64url>("");
+
+        test_codec<base16<wchar_t> >(L"\n");
+        test_codec<base64<wchar_t> >(L"\r\n");
+
+        test_padding<base32<char> >("\n");
+        test_padding<base64<char> >("\r\n");
+    }
+}
+
+void test_wrap()
+{
+    using namespace stlencoders;
+
+    // MIME lines hold 57 octets
+    std::string s = randstr(57 * 3);
+    std::string t(base64<char>::wrapped_encode_size(s.size(), 76, "\r\n"), '\0');
+    base64<char>::encode_wrapped(s.begin(), s.end(), t.begin(), 76, "\r\n");
+    assert(t.size() == 76 * 3 + 2 * 2);
+    assert(t.substr(76, 2) == "\r\n");
+    assert(t.substr(154, 2) == "\r\n");
+
+    // lines too long to be buffered
+    const std::size_t cols[] = { 100001, std::size_t(-1) / 2 };
+    for (std::size_t i = 0; i != sizeof cols / sizeof cols[0]; ++i) {
+        std::string e = seqenc<base32<char> >(s);
+        std::string w(base32<char>::wrapped_encode_size(s.size(), cols[i], "\n"), '\0');
+        base32<char>::encode_wrapped(s.begin(), s.end(), w.begin(), cols[i], "\n");
+        assert(w == e);
+    }
+
+    for_each_simd_level(test_levels);
+}
+
+#ifndef UNITTEST
+int main()
+{
+    test_wrap();
+    return EXIT_SUCCESS;
+}
+#endif
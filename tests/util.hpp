@@ -25,10 +25,15 @@
 #ifndef UTIL_HPP
 #define UTIL_HPP
 
+#include "dispatch.hpp"
 #include "xassert.hpp"
 
 #include <cassert>
+#include <cstdlib>
+#include <iterator>
+#include <list>
 #include <string>
+#include <vector>
 
 namespace {
     template<class C>
@@ -85,6 +90,99 @@ namespace {
         return dst;
     }
 
+    template<class C>
+    std::basic_string<typename C::char_type> ptrenc(const std::string& src)
+    {
+        typedef typename C::char_type char_type;
+
+        std::vector<char_type> dst(C::max_encode_size(src.size()) + 1);
+        const char* first = src.data();
+        char_type* end = C::encode(first, first + src.size(), &dst[0]);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::basic_string<char_type>(&dst[0], end);
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> ptrenc(const std::string& src, bool pad)
+    {
+        typedef typename C::char_type char_type;
+
+        std::vector<char_type> dst(C::max_encode_size(src.size()) + 1);
+        const char* first = src.data();
+        char_type* end = C::encode(first, first + src.size(), &dst[0], pad);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::basic_string<char_type>(&dst[0], end);
+    }
+
+    template<class C>
+    std::string ptrdec(const std::basic_string<typename C::char_type>& src)
+    {
+        typedef typename C::char_type char_type;
+
+        std::vector<char> dst(C::max_decode_size(src.size()) + 1);
+        const char_type* first = src.data();
+        char* end = C::decode(first, first + src.size(), &dst[0]);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::string(&dst[0], end);
+    }
+
+    template<class C, class Predicate>
+    std::string ptrdec(const std::basic_string<typename C::char_type>& src, Predicate pred)
+    {
+        typedef typename C::char_type char_type;
+
+        std::vector<char> dst(C::max_decode_size(src.size()) + 1);
+        const char_type* first = src.data();
+        char* end = C::decode(first, first + src.size(), &dst[0], pred);
+        assert(end - &dst[0] < static_cast<long>(dst.size()));
+        return std::string(&dst[0], end);
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> seqenc(const std::string& src)
+    {
+        std::list<char> seq(src.begin(), src.end());
+        std::basic_string<typename C::char_type> dst;
+        C::encode(seq.begin(), seq.end(), std::back_inserter(dst));
+        return dst;
+    }
+
+    template<class C>
+    std::basic_string<typename C::char_type> seqenc(const std::string& src, bool pad)
+    {
+        std::list<char> seq(src.begin(), src.end());
+        std::basic_string<typename C::char_type> dst;
+        C::encode(seq.begin(), seq.end(), std::back_inserter(dst), pad);
+        return dst;
+    }
+
+    template<class C>
+    std::string seqdec(const std::basic_string<typename C::char_type>& src)
+    {
+        std::list<typename C::char_type> seq(src.begin(), src.end());
+        std::string dst;
+        C::decode(seq.begin(), seq.end(), std::back_inserter(dst));
+        return dst;
+    }
+
+    template<class C, class Predicate>
+    std::string seqdec(const std::basic_string<typename C::char_type>& src, Predicate pred)
+    {
+        std::list<typename C::char_type> seq(src.begin(), src.end());
+        std::string dst;
+        C::decode(seq.begin(), seq.end(), std::back_inserter(dst), pred);
+        return dst;
+    }
+
+    inline std::string randstr(std::size_t n)
+    {
+        std::string s(n, '\0');
+        for (std::size_t i = 0; i != n; ++i) {
+            s[i] = static_cast<char>(std::rand());
+        }
+        return s;
+    }
+
     template<class charT>
     class skip {
     public:
@@ -107,6 +205,58 @@ namespace {
     {
         return skip<charT>(s);
     }
+
+    const char* const whitespace = " \t\n\v\f\r";
+
+    template<class charT>
+    std::basic_string<charT> wrap(
+        const std::basic_string<charT>& s, std::size_t cols, const charT* eol
+        )
+    {
+        if (cols == 0) {
+            return s;
+        }
+
+        std::basic_string<charT> t;
+        for (std::size_t i = 0; i < s.size(); i += cols) {
+            if (i != 0) {
+                t += eol;
+            }
+            t += s.substr(i, cols);
+        }
+        return t;
+    }
+
+    template<class charT>
+    std::basic_string<charT> wrap(const std::basic_string<charT>& s, std::size_t cols)
+    {
+        const charT eol[] = { charT('\n'), charT() };
+        return wrap(s, cols, eol);
+    }
+
+    // inserts runs of up to n whitespace characters at random positions
+    inline std::string scatter(const std::string& s, std::size_t n = 1)
+    {
+        std::string t;
+        for (std::size_t i = 0; i != s.size(); ++i) {
+            if (std::rand() % 5 == 0) {
+                t.append(std::rand() % n + 1, whitespace[std::rand() % 6]);
+            }
+            t += s[i];
+        }
+        return t;
+    }
+
+    // runs f for each supported SIMD level, restoring the current one
+    inline void for_each_simd_level(void (*f)())
+    {
+        stlencoders::simd_level level = stlencoders::get_simd_level();
+        for (int i = stlencoders::simd_scalar; i <= stlencoders::detect_simd_level(); ++i) {
+            stlencoders::set_simd_level(static_cast<stlencoders::simd_level>(i));
+            f();
+        }
+        stlencoders::set_simd_level(level);
+    }
 }
 
 #endif
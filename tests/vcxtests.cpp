@@ -28,8 +28,17 @@
 #include "test_base16.hpp"
 #include "test_base32.hpp"
 #include "test_base64.hpp"
+#include "test_buffer.hpp"
+#include "test_chunk.hpp"
+#include "test_dispatch.hpp"
 #include "test_lookup.hpp"
+#include "test_parallel.hpp"
+#include "test_skip.hpp"
+#include "test_streambuf.hpp"
 #include "test_traits.hpp"
+#include "test_try_decode.hpp"
+#include "test_validate.hpp"
+#include "test_wrap.hpp"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -56,14 +65,59 @@ namespace tests {
             test_base64();
         }
 
+        TEST_METHOD(buffer)
+        {
+            test_buffer();
+        }
+
+        TEST_METHOD(chunk)
+        {
+            test_chunk();
+        }
+
+        TEST_METHOD(dispatch)
+        {
+            test_dispatch();
+        }
+
         TEST_METHOD(lookup)
         {
             test_lookup();
         }
 
+        TEST_METHOD(parallel)
+        {
+            test_parallel();
+        }
+
+        TEST_METHOD(skip)
+        {
+            test_skip();
+        }
+
+        TEST_METHOD(streambuf)
+        {
+            test_streambuf();
+        }
+
         TEST_METHOD(traits)
         {
             test_traits();
         }
+
+        TEST_METHOD(try_decode)
+        {
+            test_try_decode();
+        }
+
+        TEST_METHOD(validate)
+        {
+            test_validate();
+        }
+
+        TEST_METHOD(wrap)
+        {
+            test_wrap();
+        }
     };
 }